@@ -40,8 +40,9 @@ int main(int argc, char **argv)
                 SDL_Log("Failed to finish write to %s: %s", argv[i], SDL_GetError());
             } else {
                 char buf[512];
+                NET_IOVec iov = { buf, (int) sizeof (buf) };
                 int br;
-                while ((br = NET_ReadFromStreamSocket(sock, buf, sizeof (buf))) >= 0) {
+                while ((NET_WaitUntilInputAvailable((void **) &sock, 1, -1) >= 0) && ((br = NET_FillFromStreamSocketV(sock, &iov, 1)) >= 0)) {
                     fwrite(buf, 1, br, stdout);
                 }
 
@@ -93,6 +93,7 @@
  *
  * - NET_WaitUntilConnected
  * - NET_WaitUntilInputAvailable
+ * - NET_WaitUntilNewInputAvailable
  * - NET_WaitUntilResolved
  * - NET_WaitUntilStreamSocketDrained
  *
@@ -684,9 +685,87 @@ typedef struct NET_StreamSocket NET_StreamSocket;
  * you do not have to byteswap it into "network order," as the library will
  * handle that for you.
  *
- * There are currently no extra properties for creating a client, so `props`
- * should be zero. A future revision of SDL_net may add additional (optional)
- * properties.
+ * The caller may supply properties to tune the connection. This is optional,
+ * and a value of zero for `props` will request defaults for all properties.
+ * Any property that isn't set leaves the operating system's default alone.
+ * Options that a platform doesn't offer are quietly ignored; if the system
+ * rejects a value, this function fails.
+ *
+ * These are the supported properties:
+ *
+ * - `NET_PROP_STREAM_SOCKET_NODELAY_BOOLEAN`: true to send small writes
+ *   immediately, instead of holding them briefly to combine them with later
+ *   writes (this sets `TCP_NODELAY`, disabling Nagle's algorithm). Apps that
+ *   send small requests and wait for replies usually want this, as the delay
+ *   can add tens of milliseconds to each exchange.
+ * - `NET_PROP_STREAM_SOCKET_SEND_BUFFER_SIZE_NUMBER`: the size, in bytes, of
+ *   the system's send buffer for this socket (`SO_SNDBUF`). Systems may round
+ *   or limit this value.
+ * - `NET_PROP_STREAM_SOCKET_RECEIVE_BUFFER_SIZE_NUMBER`: the size, in bytes,
+ *   of the system's receive buffer for this socket (`SO_RCVBUF`). Systems may
+ *   round or limit this value.
+ * - `NET_PROP_STREAM_SOCKET_QUICKACK_BOOLEAN`: true to acknowledge received
+ *   data right away instead of delaying acknowledgements (`TCP_QUICKACK`,
+ *   Linux only). The system may fall back to delayed acknowledgements later
+ *   on its own.
+ * - `NET_PROP_STREAM_SOCKET_NOTSENT_LOWAT_NUMBER`: the number of unsent bytes
+ *   the system may hold for this socket before it stops reporting it as
+ *   writable (`TCP_NOTSENT_LOWAT`, Linux and Apple platforms). Smaller values
+ *   keep more data in the app's hands, where it can still be reprioritized.
+ * - `NET_PROP_STREAM_SOCKET_KEEPALIVE_BOOLEAN`: true to have the system
+ *   periodically check that an idle connection is still alive, so a dead
+ *   peer is eventually reported as a failure (`SO_KEEPALIVE`).
+ * - `NET_PROP_STREAM_SOCKET_KEEPALIVE_IDLE_NUMBER`: seconds a connection must
+ *   be idle before keepalive checks start.
+ * - `NET_PROP_STREAM_SOCKET_KEEPALIVE_INTERVAL_NUMBER`: seconds between
+ *   keepalive checks.
+ * - `NET_PROP_STREAM_SOCKET_KEEPALIVE_COUNT_NUMBER`: number of unanswered
+ *   keepalive checks before the connection is considered dead.
+ * - `NET_PROP_STREAM_SOCKET_TOS_NUMBER`: the type-of-service byte for
+ *   outgoing packets (`IP_TOS`, or `IPV6_TCLASS` for IPv6). The DSCP value
+ *   goes in the top six bits, so for DSCP value `d`, use `d << 2`.
+ * - `NET_PROP_STREAM_SOCKET_PRIORITY_NUMBER`: the priority of this socket's
+ *   outgoing packets on the local system's queues (`SO_PRIORITY`, Linux
+ *   only).
+ *
+ * These properties only apply to clients:
+ *
+ * - `NET_PROP_CLIENT_HAPPY_EYEBALLS_BOOLEAN`: true to try every address that
+ *   `address` resolved to, instead of just the first one. Hostnames often
+ *   resolve to several addresses, some IPv6 and some IPv4, and some of them
+ *   might not be reachable from this network; normally, if the first one
+ *   doesn't work, the connection takes as long as the system's connection
+ *   timeout (often many seconds) to fail. With this property set, the
+ *   library starts connecting to the first address (preferring IPv6), and if
+ *   it hasn't connected after a short delay, starts connecting to the next
+ *   address (alternating between IPv6 and IPv4) while the first keeps
+ *   trying, and so on, keeping whichever connects first and closing the
+ *   rest. This is the "Happy Eyeballs" algorithm from RFC 8305. The race
+ *   makes progress while the app waits on the socket with
+ *   NET_WaitUntilConnected(), NET_WaitUntilInputAvailable(), etc. Data
+ *   written before the connection is made is queued until then. Thread-safe
+ *   writes can't be enabled on the socket until it connects. This property
+ *   defaults to false.
+ * - `NET_PROP_CLIENT_HAPPY_EYEBALLS_DELAY_NUMBER`: the number of
+ *   milliseconds to give a connection attempt before starting the next one
+ *   alongside it, when `NET_PROP_CLIENT_HAPPY_EYEBALLS_BOOLEAN` is true. If
+ *   an attempt fails outright, the next one starts immediately. This
+ *   property defaults to 250.
+ * - `NET_PROP_CLIENT_FASTOPEN_BOOLEAN`: true to use TCP Fast Open, which
+ *   lets data written before the connection is made travel with the
+ *   connection request itself, instead of waiting a full round trip for the
+ *   handshake to finish. This helps short request/response connections to a
+ *   server that has been contacted before (the first connection fetches a
+ *   cookie from the server that later ones use). With this property set,
+ *   the socket may report that it is connected before the server has
+ *   actually answered, so a connection that fails shows up as a failure on
+ *   a later read or write instead. The server must support Fast Open too
+ *   (see `NET_PROP_SERVER_FASTOPEN_QUEUE_NUMBER`); if it doesn't, the
+ *   connection proceeds normally. Since the first data might be delivered
+ *   more than once by the network, only use this for requests that are safe
+ *   to repeat. This is currently only supported on Linux, and is ignored
+ *   elsewhere, and when `NET_PROP_CLIENT_HAPPY_EYEBALLS_BOOLEAN` is true.
+ *   This property defaults to false.
  *
  * \param address the address of the remote server to connect to.
  * \param port the port on the remote server to connect to.
@@ -704,6 +783,21 @@ typedef struct NET_StreamSocket NET_StreamSocket;
  */
 extern SDL_DECLSPEC NET_StreamSocket * SDLCALL NET_CreateClient(NET_Address *address, Uint16 port, SDL_PropertiesID props);
 
+#define NET_PROP_STREAM_SOCKET_NODELAY_BOOLEAN                "NET.stream_socket.nodelay"
+#define NET_PROP_STREAM_SOCKET_SEND_BUFFER_SIZE_NUMBER        "NET.stream_socket.send_buffer_size"
+#define NET_PROP_STREAM_SOCKET_RECEIVE_BUFFER_SIZE_NUMBER     "NET.stream_socket.receive_buffer_size"
+#define NET_PROP_STREAM_SOCKET_QUICKACK_BOOLEAN               "NET.stream_socket.quickack"
+#define NET_PROP_STREAM_SOCKET_NOTSENT_LOWAT_NUMBER           "NET.stream_socket.notsent_lowat"
+#define NET_PROP_STREAM_SOCKET_KEEPALIVE_BOOLEAN              "NET.stream_socket.keepalive"
+#define NET_PROP_STREAM_SOCKET_KEEPALIVE_IDLE_NUMBER          "NET.stream_socket.keepalive_idle"
+#define NET_PROP_STREAM_SOCKET_KEEPALIVE_INTERVAL_NUMBER      "NET.stream_socket.keepalive_interval"
+#define NET_PROP_STREAM_SOCKET_KEEPALIVE_COUNT_NUMBER         "NET.stream_socket.keepalive_count"
+#define NET_PROP_STREAM_SOCKET_TOS_NUMBER                     "NET.stream_socket.tos"
+#define NET_PROP_STREAM_SOCKET_PRIORITY_NUMBER                "NET.stream_socket.priority"
+#define NET_PROP_CLIENT_HAPPY_EYEBALLS_BOOLEAN                "NET.client.happy_eyeballs"
+#define NET_PROP_CLIENT_HAPPY_EYEBALLS_DELAY_NUMBER           "NET.client.happy_eyeballs_delay"
+#define NET_PROP_CLIENT_FASTOPEN_BOOLEAN                      "NET.client.fastopen"
+
 /**
  * Block until a stream socket has connected to a server.
  *
@@ -813,6 +907,44 @@ typedef struct NET_Server NET_Server;
  *   operating system level, this defaults to false!). If this property is
  *   false and the OS feels that not enough time has elapsed, server creation
  *   will fail and this function will report an error.
+ * - `NET_PROP_SERVER_REUSEPORT_BOOLEAN`: true if several servers should be
+ *   allowed to listen on the same address and port at the same time, with
+ *   the operating system spreading new connections between them. This sets
+ *   `SO_REUSEPORT` (or `SO_REUSEPORT_LB` on FreeBSD) on the listen sockets.
+ *   Every server sharing the port must set this property. This is how an app
+ *   can accept and serve connections on multiple CPU cores: create one
+ *   server per worker thread, each with this property set, and have each
+ *   thread call NET_WaitUntilInputAvailable() and NET_AcceptClient() on its
+ *   own server and the stream sockets it accepted. Linux and FreeBSD balance
+ *   new connections across the servers; other platforms might not balance
+ *   them evenly, or at all. This property defaults to false. If it is true on
+ *   a platform that doesn't support `SO_REUSEPORT` (such as Windows), server
+ *   creation will fail and this function will report an error.
+ * - `NET_PROP_SERVER_BACKLOG_NUMBER`: the number of connections the system
+ *   may hold for the server before the app accepts them. When this many are
+ *   waiting, new connection attempts are dropped or refused, and clients
+ *   might wait several seconds before trying again, so servers that get
+ *   bursts of connections (for example, every client reconnecting at once
+ *   after a restart) want this to be large. The system may limit this value.
+ *   This property defaults to the system's maximum (`SOMAXCONN`).
+ * - `NET_PROP_SERVER_FASTOPEN_QUEUE_NUMBER`: if greater than zero, accept
+ *   TCP Fast Open connections, where clients send their first data along
+ *   with the connection request (see `NET_PROP_CLIENT_FASTOPEN_BOOLEAN`).
+ *   The value is the maximum number of such connections the system may hold
+ *   before the app accepts them; some platforms only care whether it's
+ *   non-zero. Data from these clients can be delivered more than once by the
+ *   network, so only enable this if the first thing clients send is safe to
+ *   repeat. On Linux, the system must also allow it (the
+ *   `net.ipv4.tcp_fastopen` sysctl needs its `2` bit set). If the platform
+ *   doesn't support Fast Open, clients just connect normally. This property
+ *   defaults to zero.
+ *
+ * The server also accepts all the `NET_PROP_STREAM_SOCKET_*` properties that
+ * NET_CreateClient() does, and applies the ones that are set to every stream
+ * socket that NET_AcceptClient() returns. They are also set on the server's
+ * own listen sockets, so bad values make this function fail instead of
+ * NET_AcceptClient(), and options like buffer sizes are in place when
+ * connections are first negotiated.
  *
  * \param addr the _local_ address to listen for connections on, or NULL.
  * \param port the port on the local address to listen for connections on.
@@ -831,6 +963,9 @@ typedef struct NET_Server NET_Server;
 extern SDL_DECLSPEC NET_Server * SDLCALL NET_CreateServer(NET_Address *addr, Uint16 port, SDL_PropertiesID props);
 
 #define NET_PROP_SERVER_REUSEADDR_BOOLEAN     "NET.server.reuseaddr"
+#define NET_PROP_SERVER_REUSEPORT_BOOLEAN     "NET.server.reuseport"
+#define NET_PROP_SERVER_BACKLOG_NUMBER        "NET.server.backlog"
+#define NET_PROP_SERVER_FASTOPEN_QUEUE_NUMBER "NET.server.fastopen_queue"
 
 
 /**
@@ -875,6 +1010,48 @@ extern SDL_DECLSPEC NET_Server * SDLCALL NET_CreateServer(NET_Address *addr, Uin
  */
 extern SDL_DECLSPEC bool SDLCALL NET_AcceptClient(NET_Server *server, NET_StreamSocket **client_stream);
 
+/**
+ * Create stream sockets for several pending client connections at once.
+ *
+ * This works like NET_AcceptClient(), but accepts up to `max` pending
+ * connections in one call, which is convenient when a server gets woken up
+ * by NET_WaitUntilInputAvailable() and wants to take everything that's
+ * waiting. If the server listens on more than one address, this takes turns
+ * between them.
+ *
+ * This function does not block. If fewer than `max` connections are pending,
+ * it accepts what is there and returns how many that was, which can be zero.
+ * This is not an error and a common condition the app should expect. If
+ * this returns `max`, there might be more connections waiting.
+ *
+ * If accepting a connection fails after others were already accepted by this
+ * call, this returns the ones it got; the failure will probably be reported
+ * by the next call.
+ *
+ * When done with the newly-accepted clients, you can disconnect and dispose
+ * of each stream socket by calling NET_DestroyStreamSocket().
+ *
+ * \param server the server object to check for pending connections.
+ * \param clients an array that will be filled in with new stream sockets.
+ * \param max the maximum number of connections to accept; `clients` must
+ *            have room for at least this many.
+ * \returns the number of stream sockets stored in `clients` (zero if no new
+ *          connections were pending), or -1 on error; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same server from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               servers at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_AcceptClient
+ * \sa NET_WaitUntilInputAvailable
+ * \sa NET_DestroyStreamSocket
+ */
+extern SDL_DECLSPEC int SDLCALL NET_AcceptClients(NET_Server *server, NET_StreamSocket **clients, int max);
+
 /**
  * Dispose of a previously-created server.
  *
@@ -990,8 +1167,11 @@ extern SDL_DECLSPEC NET_Status SDLCALL NET_GetConnectionStatus(NET_StreamSocket
  *
  * \threadsafety You should not operate on the same socket from multiple
  *               threads at the same time without supplying a serialization
- *               mechanism. However, different threads may access different
- *               sockets at the same time without problems.
+ *               mechanism, unless the socket has thread-safe writes enabled
+ *               with NET_SetStreamSocketThreadSafeWrites(), in which case
+ *               this function may be called from any thread. Different
+ *               threads may access different sockets at the same time
+ *               without problems.
  *
  * \since This function is available since SDL_net 3.0.0.
  *
@@ -1001,6 +1181,282 @@ extern SDL_DECLSPEC NET_Status SDLCALL NET_GetConnectionStatus(NET_StreamSocket
  */
 extern SDL_DECLSPEC bool SDLCALL NET_WriteToStreamSocket(NET_StreamSocket *sock, const void *buf, int buflen);
 
+/**
+ * One buffer in a list of buffers for scatter/gather I/O.
+ *
+ * \since This datatype is available since SDL_net 3.4.0.
+ *
+ * \sa NET_WriteToStreamSocketV
+ * \sa NET_ReadFromStreamSocketV
+ */
+typedef struct NET_IOVec
+{
+    void *buf;  /**< the data to send, or where to put received data. */
+    int buflen;  /**< the number of bytes available at `buf`. */
+} NET_IOVec;
+
+/**
+ * Send several buffers of bytes to a connected stream socket at once.
+ *
+ * This works like NET_WriteToStreamSocket(), but the data to send is
+ * collected from several buffers, in order, as if they had been copied into
+ * one contiguous buffer first. This is useful for sending a header and a
+ * payload that live in separate places without copying them together or
+ * making a separate write for each.
+ *
+ * When possible, all the buffers are handed to the system in a single call.
+ * If the system can't take all the data right now, whatever is left over is
+ * queued for later transmission, just like NET_WriteToStreamSocket() does.
+ *
+ * Buffers with a `buflen` of zero are skipped, and may have a NULL `buf`.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning false. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to send data through.
+ * \param iov an array of buffers to send, in order.
+ * \param iovcnt the number of items in `iov`.
+ * \returns true if data sent or queued for transmission, false on failure;
+ *          call SDL_GetError() for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism, unless the socket has thread-safe writes enabled
+ *               with NET_SetStreamSocketThreadSafeWrites(), in which case
+ *               this function may be called from any thread. Different
+ *               threads may access different sockets at the same time
+ *               without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_WriteToStreamSocket
+ * \sa NET_GetStreamSocketPendingWrites
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_WriteToStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt);
+
+/**
+ * Send part of a file through a connected stream socket.
+ *
+ * This sends `len` bytes from `io`, starting at `offset`, as if they had been
+ * read into memory and passed to NET_WriteToStreamSocket(), but without
+ * copying the whole thing into memory first. This is useful for serving
+ * large files.
+ *
+ * On platforms that support it (currently Linux), if `io` is backed by a
+ * file descriptor, the system copies the data straight from the file to the
+ * socket without it passing through the app at all. Otherwise, the data is
+ * read from `io` a small piece at a time as the socket is ready for more.
+ *
+ * Like NET_WriteToStreamSocket(), this never blocks; whatever can't be sent
+ * immediately is queued, in order with other writes to this socket, and
+ * sent later. Only the file range is queued, not the file's data, so the app
+ * must not close `io` (unless `closeio` is true, in which case the library
+ * closes it when it's done with it) or change the file until the data has
+ * been sent. NET_GetStreamSocketPendingWrites() includes queued file data in
+ * its count.
+ *
+ * The library will seek around in `io` when it can't use a system shortcut,
+ * so the app shouldn't rely on its current position while data is queued.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), or the file can't be read, this
+ * function will report failure by returning false. Stream sockets only
+ * report failure for unrecoverable conditions; once a stream socket fails,
+ * you should assume it is no longer usable and should destroy it with
+ * NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to send data through.
+ * \param io the stream to read data from.
+ * \param offset the position in `io` of the first byte to send.
+ * \param len the number of bytes to send, or -1 to send everything up to the
+ *            end of `io`.
+ * \param closeio if true, calls SDL_CloseIO() on `io` once it has been sent,
+ *                the socket is destroyed, or this function fails.
+ * \returns true if data sent or queued for transmission, false on failure;
+ *          call SDL_GetError() for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism, unless the socket has thread-safe writes enabled
+ *               with NET_SetStreamSocketThreadSafeWrites(), in which case
+ *               this function may be called from any thread. Different
+ *               threads may access different sockets at the same time
+ *               without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_WriteToStreamSocket
+ * \sa NET_GetStreamSocketPendingWrites
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_SendFileToStreamSocket(NET_StreamSocket *sock, SDL_IOStream *io, Sint64 offset, Sint64 len, bool closeio);
+
+/**
+ * Send bytes over a stream socket without copying them, when possible.
+ *
+ * This works like NET_WriteToStreamSocket(), but for large buffers, the
+ * library doesn't make its own copy of the data. Instead, on platforms that
+ * support it (currently Linux, with MSG_ZEROCOPY), the system sends straight
+ * from the app's memory, which saves a lot of copying for large transfers.
+ *
+ * In exchange, the app must not change or free `buf` until the library is
+ * done with it. Each call returns an ID, which increases by one with each
+ * call on a given socket; once NET_GetStreamSocketZeroCopyCompleted()
+ * reports an ID at least as large as the one returned here, the buffer may
+ * be reused. Completions are reported in order.
+ *
+ * Small writes aren't worth the trouble, so they are copied like any other
+ * write, and their IDs are complete as soon as this function returns, once
+ * any earlier zero-copy writes have completed. On platforms without
+ * zero-copy support, large buffers are still sent directly from `buf` as the
+ * socket is ready for them, and complete once they've been handed to the
+ * system.
+ *
+ * Like NET_WriteToStreamSocket(), this never blocks, and data is sent in
+ * order with other writes to this socket. NET_GetStreamSocketPendingWrites()
+ * includes this data in its count until it has been handed to the system.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning -1. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to send data through.
+ * \param buf a pointer to the data to send.
+ * \param buflen the size of the data to send, in bytes.
+ * \returns an ID for this write, which is always greater than zero, or -1 on
+ *          failure; call SDL_GetError() for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism, unless the socket has thread-safe writes enabled
+ *               with NET_SetStreamSocketThreadSafeWrites(), in which case
+ *               this function may be called from any thread. Different
+ *               threads may access different sockets at the same time
+ *               without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_GetStreamSocketZeroCopyCompleted
+ * \sa NET_WriteToStreamSocket
+ */
+extern SDL_DECLSPEC Sint64 SDLCALL NET_WriteToStreamSocketZeroCopy(NET_StreamSocket *sock, const void *buf, int buflen);
+
+/**
+ * Find out which zero-copy writes on a stream socket have completed.
+ *
+ * This returns the largest ID, returned by NET_WriteToStreamSocketZeroCopy(),
+ * whose buffer the library and the system are done with. That buffer, and
+ * the buffers of every earlier write, may be changed or freed by the app.
+ *
+ * This also makes progress sending pending data, like
+ * NET_GetStreamSocketPendingWrites() does.
+ *
+ * The system reports completions as the remote side acknowledges data, so
+ * NET_WaitUntilInputAvailable() will also return when new completions arrive
+ * for a socket using zero-copy writes.
+ *
+ * \param sock the stream socket to query.
+ * \returns the ID of the most recent completed zero-copy write, zero if none
+ *          have completed yet, or -1 on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism, unless the socket has thread-safe writes enabled
+ *               with NET_SetStreamSocketThreadSafeWrites(), in which case
+ *               this function may be called from any thread. Different
+ *               threads may access different sockets at the same time
+ *               without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_WriteToStreamSocketZeroCopy
+ */
+extern SDL_DECLSPEC Sint64 SDLCALL NET_GetStreamSocketZeroCopyCompleted(NET_StreamSocket *sock);
+
+/**
+ * Hold writes to a stream socket so they can be sent together.
+ *
+ * Normally, each write to a stream socket tries to send its data right away,
+ * which means a system call (and often a separate network packet) for every
+ * write. If an app builds its output from many small writes, it can cork the
+ * socket first: while corked, writes only add data to the socket's queue,
+ * and nothing is sent until the app calls NET_FlushStreamSocket(), uncorks
+ * the socket, or waits on it with NET_WaitUntilInputAvailable() (so corked
+ * data goes out at the end of each pass through an app's event loop without
+ * any extra effort). Queued writes are then sent together in a single system
+ * call, but data queued by NET_SendFileToStreamSocket() or
+ * NET_WriteToStreamSocketZeroCopy() is sent on its own, so the batch is split
+ * into separate calls around each of those.
+ *
+ * Reading from a corked socket doesn't send its queued data, either. Calling
+ * NET_GetStreamSocketPendingWrites() or NET_WaitUntilStreamSocketDrained()
+ * does.
+ *
+ * Uncorking a socket sends anything that was queued while it was corked.
+ *
+ * Sockets are not corked by default.
+ *
+ * \param sock the stream socket to cork or uncork.
+ * \param corked true to hold writes until a flush, false to send them right
+ *               away again.
+ * \returns true on success, false on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_FlushStreamSocket
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_SetStreamSocketCorked(NET_StreamSocket *sock, bool corked);
+
+/**
+ * Send data queued on a stream socket now.
+ *
+ * This is mostly useful with sockets corked by NET_SetStreamSocketCorked(),
+ * to send everything written since the last flush with as few system calls
+ * as possible. Ordinary writes go out together in one call, but the batch is
+ * split into separate calls around data queued by
+ * NET_SendFileToStreamSocket() or NET_WriteToStreamSocketZeroCopy(), which
+ * is sent on its own. The socket stays corked afterwards.
+ *
+ * Like other writes, this never blocks. Whatever the system won't take right
+ * now stays queued, and is sent as the socket is ready for more; use
+ * NET_GetStreamSocketPendingWrites() to see how much is left.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning false. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to flush.
+ * \returns true on success, false on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism, unless the socket has thread-safe writes enabled
+ *               with NET_SetStreamSocketThreadSafeWrites(), in which case
+ *               this function may be called from any thread. Different
+ *               threads may access different sockets at the same time
+ *               without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_SetStreamSocketCorked
+ * \sa NET_GetStreamSocketPendingWrites
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_FlushStreamSocket(NET_StreamSocket *sock);
+
 /**
  * Query bytes still pending transmission on a stream socket.
  *
@@ -1023,8 +1479,11 @@ extern SDL_DECLSPEC bool SDLCALL NET_WriteToStreamSocket(NET_StreamSocket *sock,
  *
  * \threadsafety You should not operate on the same socket from multiple
  *               threads at the same time without supplying a serialization
- *               mechanism. However, different threads may access different
- *               sockets at the same time without problems.
+ *               mechanism, unless the socket has thread-safe writes enabled
+ *               with NET_SetStreamSocketThreadSafeWrites(), in which case
+ *               this function may be called from any thread. Different
+ *               threads may access different sockets at the same time
+ *               without problems.
  *
  * \since This function is available since SDL_net 3.0.0.
  *
@@ -1064,8 +1523,11 @@ extern SDL_DECLSPEC int SDLCALL NET_GetStreamSocketPendingWrites(NET_StreamSocke
  *
  * \threadsafety You should not operate on the same socket from multiple
  *               threads at the same time without supplying a serialization
- *               mechanism. However, different threads may access different
- *               sockets at the same time without problems.
+ *               mechanism, unless the socket has thread-safe writes enabled
+ *               with NET_SetStreamSocketThreadSafeWrites(), in which case
+ *               this function may be called from any thread. Different
+ *               threads may access different sockets at the same time
+ *               without problems.
  *
  * \since This function is available since SDL_net 3.0.0.
  *
@@ -1074,6 +1536,63 @@ extern SDL_DECLSPEC int SDLCALL NET_GetStreamSocketPendingWrites(NET_StreamSocke
  */
 extern SDL_DECLSPEC int SDLCALL NET_WaitUntilStreamSocketDrained(NET_StreamSocket *sock, Sint32 timeout);
 
+/**
+ * Allow multiple threads to write to a stream socket at the same time.
+ *
+ * Normally, a stream socket must only be used by one thread at a time. A
+ * common pattern, though, is to have one thread reading from a connection
+ * while other threads write to it. Enabling thread-safe writes makes that
+ * work.
+ *
+ * In this mode, the functions that write to a stream socket
+ * (NET_WriteToStreamSocket(), NET_WriteToStreamSocketV(), NET_SendMessage(),
+ * NET_SendFileToStreamSocket() and NET_WriteToStreamSocketZeroCopy()),
+ * NET_GetStreamSocketPendingWrites(), NET_GetStreamSocketZeroCopyCompleted(),
+ * NET_FlushStreamSocket() and NET_WaitUntilStreamSocketDrained() may be
+ * called from any thread, and concurrently with whatever thread is reading
+ * from the socket or waiting on it with NET_WaitUntilInputAvailable().
+ * Written data is copied onto a lock-free queue, and then sent by whichever
+ * thread gets to the socket first; a thread never waits for another thread
+ * to finish sending, so the reading thread never blocks on writers. If the
+ * system can't take all the data right away, a thread blocked in
+ * NET_WaitUntilInputAvailable() on the socket is woken up to send the rest
+ * as the connection allows. Data from each individual write call stays
+ * contiguous in the stream, but writes from different threads are sent in
+ * whatever order they reached the queue.
+ *
+ * NET_SendFileToStreamSocket(), NET_WriteToStreamSocketZeroCopy() and
+ * NET_GetStreamSocketZeroCopyCompleted() don't copy data onto the queue, so
+ * they take a short lock instead, which can make them wait for another
+ * thread that is in the middle of sending on the same socket. Threads that
+ * only use the other functions never wait on them.
+ *
+ * Everything else (reading, destroying the socket, etc) still has to happen
+ * on one thread at a time, and all writers should be finished with the
+ * socket before it is destroyed.
+ *
+ * Thread-safe writes cost an extra allocation and copy per write, and an
+ * extra internal socket to wake up waiting threads, so they are disabled by
+ * default. Simulated packet loss (NET_SimulateStreamPacketLoss) only delays
+ * reads on sockets in this mode.
+ *
+ * The mode should be set before other threads start writing to the socket;
+ * it is only safe to disable it again once no other threads are writing.
+ *
+ * \param sock the stream socket to change.
+ * \param enabled true to allow writes from any thread, false to go back to
+ *                the default behavior.
+ * \returns true on success, false on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety This function should not be called while other threads are
+ *               using the socket.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_WriteToStreamSocket
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_SetStreamSocketThreadSafeWrites(NET_StreamSocket *sock, bool enabled);
+
 
 /**
  * Receive bytes that a remote system sent to a stream socket.
@@ -1125,6 +1644,349 @@ extern SDL_DECLSPEC int SDLCALL NET_WaitUntilStreamSocketDrained(NET_StreamSocke
  */
 extern SDL_DECLSPEC int SDLCALL NET_ReadFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen);
 
+/**
+ * Receive bytes from a stream socket into several buffers at once.
+ *
+ * This works like NET_ReadFromStreamSocket(), but received data is spread
+ * across several buffers, in order: the first buffer is filled completely
+ * before any data goes into the second, and so on. This is useful for
+ * reading a fixed-size header directly into a struct and the rest of the
+ * data into a separate buffer, without an extra copy.
+ *
+ * When possible, all the buffers are handed to the system in a single call.
+ * Like NET_ReadFromStreamSocket(), this reads whatever is available right
+ * now, which might be less than the buffers can hold. To keep reading until
+ * the buffers are full or no more data is available, use
+ * NET_FillFromStreamSocketV() instead.
+ *
+ * This call never blocks; if no new data is available at the time of the
+ * call, it returns 0 immediately. The caller can try again later.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning -1. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to receive data from.
+ * \param iov an array of buffers to fill, in order.
+ * \param iovcnt the number of items in `iov`.
+ * \returns number of bytes read from the stream socket (which can be less
+ *          than the buffers can hold, or zero if none available), -1 on
+ *          failure; call SDL_GetError() for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_ReadFromStreamSocket
+ * \sa NET_FillFromStreamSocketV
+ * \sa NET_WriteToStreamSocketV
+ */
+extern SDL_DECLSPEC int SDLCALL NET_ReadFromStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt);
+
+/**
+ * Receive as many bytes as are available from a stream socket, until several
+ * buffers are full.
+ *
+ * This works like NET_ReadFromStreamSocketV(), but instead of stopping after
+ * a single read, it keeps reading until all the buffers are full or the
+ * socket has no more data available right now. This replaces the usual loop
+ * of calling NET_ReadFromStreamSocket() until it returns zero.
+ *
+ * This call never blocks; if no new data is available at the time of the
+ * call, it returns 0 immediately. Use NET_WaitUntilInputAvailable() to sleep
+ * until there is more to read.
+ *
+ * If the stream ends or fails after some data was already read by this call,
+ * that data is returned, and the end of stream or failure is reported by the
+ * next read instead.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning -1. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to receive data from.
+ * \param iov an array of buffers to fill, in order.
+ * \param iovcnt the number of items in `iov`.
+ * \returns number of bytes read from the stream socket (which can be less
+ *          than the buffers can hold, or zero if none available), -1 on
+ *          failure; call SDL_GetError() for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_ReadFromStreamSocketV
+ * \sa NET_WaitUntilInputAvailable
+ */
+extern SDL_DECLSPEC int SDLCALL NET_FillFromStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt);
+
+/**
+ * Look at bytes that a remote system sent to a stream socket, without
+ * consuming them.
+ *
+ * This copies up to `buflen` bytes of data that has arrived for the stream
+ * socket into `buf`, but leaves it in place, so the next read (including
+ * NET_ReadFromStreamSocket()) will return the same data again.
+ *
+ * To do this, the library reads ahead from the socket into an internal
+ * buffer, which grows as needed. Data in this buffer is always handed out
+ * before anything else the socket receives, by every read function.
+ *
+ * This call never blocks; if no data is available at the time of the call,
+ * it returns 0 immediately. The caller can try again later.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning -1. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to look at.
+ * \param buf a pointer to a buffer where the data will be copied.
+ * \param buflen the size of the buffer pointed to by `buf`, in bytes.
+ * \returns number of bytes copied to `buf` (which can be less than `buflen`
+ *          or zero if none available), -1 on failure; call SDL_GetError()
+ *          for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_ReadFromStreamSocketUntil
+ * \sa NET_ReadExactFromStreamSocket
+ */
+extern SDL_DECLSPEC int SDLCALL NET_PeekFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen);
+
+/**
+ * Receive bytes from a stream socket up to and including a delimiter.
+ *
+ * This is useful for text protocols, where you might want to read a line
+ * ending in "\r\n", or an HTTP header block ending in "\r\n\r\n".
+ *
+ * If the delimiter has arrived, everything up to and including it is copied
+ * into `buf` and consumed, and the number of bytes copied is returned.
+ * Otherwise, nothing is consumed and this returns 0; whatever has arrived so
+ * far stays in the socket's internal buffer (see NET_PeekFromStreamSocket())
+ * and the search picks up with the new data next time. While a socket is
+ * waiting for more data like this, NET_WaitUntilInputAvailable() won't
+ * report it until more data arrives.
+ *
+ * If `buflen` bytes arrive without the delimiter showing up, this fails,
+ * since `buf` could never hold the result. The data is not consumed, so the
+ * app can still read it with NET_ReadFromStreamSocket(), etc, if it wants to
+ * recover.
+ *
+ * This call never blocks.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning -1. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to receive data from.
+ * \param delim the bytes that end the data to read.
+ * \param delimlen the size of the delimiter, in bytes.
+ * \param buf a pointer to a buffer where received data will be collected.
+ * \param buflen the size of the buffer pointed to by `buf`, in bytes. This
+ *               is the most that will be read, including the delimiter.
+ * \returns number of bytes read, including the delimiter, 0 if the delimiter
+ *          hasn't arrived yet, -1 on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_PeekFromStreamSocket
+ * \sa NET_ReadExactFromStreamSocket
+ */
+extern SDL_DECLSPEC int SDLCALL NET_ReadFromStreamSocketUntil(NET_StreamSocket *sock, const void *delim, int delimlen, void *buf, int buflen);
+
+/**
+ * Receive an exact number of bytes from a stream socket.
+ *
+ * Unlike NET_ReadFromStreamSocket(), this never returns partial data: if
+ * `buflen` bytes have arrived, they are copied into `buf` and consumed, and
+ * `buflen` is returned. Otherwise, nothing is consumed and this returns 0;
+ * whatever has arrived so far stays in the socket's internal buffer (see
+ * NET_PeekFromStreamSocket()). While a socket is waiting for more data like
+ * this, NET_WaitUntilInputAvailable() won't report it until more data
+ * arrives.
+ *
+ * This is useful for protocols with fixed-size headers or length-prefixed
+ * messages.
+ *
+ * This call never blocks.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning -1. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to receive data from.
+ * \param buf a pointer to a buffer where received data will be collected.
+ * \param buflen the number of bytes to read.
+ * \returns `buflen` if the data was read, 0 if it hasn't all arrived yet, -1
+ *          on failure; call SDL_GetError() for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_PeekFromStreamSocket
+ * \sa NET_ReadFromStreamSocketUntil
+ */
+extern SDL_DECLSPEC int SDLCALL NET_ReadExactFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen);
+
+/**
+ * Send a complete message over a stream socket.
+ *
+ * Stream sockets are just a sequence of bytes, with no concept of where one
+ * piece of data ends and the next begins. This function adds that: each
+ * message is sent as a 32-bit big-endian length followed by the message
+ * itself, and NET_ReceiveMessage() on the other end uses the length to hand
+ * back exactly one whole message at a time.
+ *
+ * The length and the message are handed to the system together in a single
+ * call, and if the socket can't take all of it right now, the rest is queued
+ * for later transmission, just like NET_WriteToStreamSocket() does. Messages
+ * sent while data is already queued are added to the same queue, so they go
+ * out together in as few system calls as possible.
+ *
+ * Otherwise, each message costs its own system call. To batch up many
+ * messages, cork the socket with NET_SetStreamSocketCorked(), send them, and
+ * then call NET_FlushStreamSocket() (or uncork the socket), which sends
+ * everything that built up in one go.
+ *
+ * Messages can be zero bytes long.
+ *
+ * This call never blocks.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning false. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to send the message through.
+ * \param buf a pointer to the message to send. May be NULL if `buflen` is
+ *            zero.
+ * \param buflen the size of the message, in bytes.
+ * \returns true if the message was sent or queued for transmission, false on
+ *          failure; call SDL_GetError() for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism, unless the socket has thread-safe writes enabled
+ *               with NET_SetStreamSocketThreadSafeWrites(), in which case
+ *               this function may be called from any thread. Different
+ *               threads may access different sockets at the same time
+ *               without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_ReceiveMessage
+ * \sa NET_SetStreamSocketCorked
+ * \sa NET_FlushStreamSocket
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_SendMessage(NET_StreamSocket *sock, const void *buf, int buflen);
+
+/**
+ * Receive a complete message from a stream socket.
+ *
+ * This reads messages sent with NET_SendMessage(): a 32-bit big-endian
+ * length, followed by that many bytes. Only whole messages are returned; if
+ * a message has only partially arrived, this reports that nothing is
+ * available yet, and the partial message stays in the socket's internal
+ * buffer until the rest shows up. While a socket is waiting for the rest of a
+ * message like this, NET_WaitUntilInputAvailable() won't report it until
+ * more data arrives.
+ *
+ * If a message is available, `*buf` is set to point to it and `*buflen` is
+ * set to its size. This points directly into the socket's internal buffer,
+ * so no copy is made; the data remains valid until the next time the app
+ * reads from this socket (with this function, NET_ReadFromStreamSocket(),
+ * etc), or destroys it. Do not free this pointer.
+ *
+ * If no complete message is available, this returns true and sets `*buf` to
+ * NULL. Since messages can be zero bytes long, check `*buf`, not `*buflen`.
+ *
+ * Messages larger than the socket's limit (16 megabytes by default, see
+ * NET_SetStreamSocketMaxMessageSize()) are treated as a failure, since the
+ * other side is either misbehaving or not speaking this protocol.
+ *
+ * This call never blocks.
+ *
+ * If the connection has failed (remote side dropped us, or one of a million
+ * other networking failures occurred), this function will report failure by
+ * returning false. Stream sockets only report failure for unrecoverable
+ * conditions; once a stream socket fails, you should assume it is no longer
+ * usable and should destroy it with NET_DestroyStreamSocket().
+ *
+ * \param sock the stream socket to receive a message from.
+ * \param buf on return, a pointer to the message, or NULL if none available.
+ * \param buflen on return, the size of the message, in bytes.
+ * \returns true if a message was received or none are available, false on
+ *          failure; call SDL_GetError() for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_SendMessage
+ * \sa NET_SetStreamSocketMaxMessageSize
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_ReceiveMessage(NET_StreamSocket *sock, const void **buf, int *buflen);
+
+/**
+ * Set the largest message NET_ReceiveMessage() will accept on a stream
+ * socket.
+ *
+ * NET_ReceiveMessage() has to buffer an entire message before it can hand it
+ * to the app, so this limit keeps a misbehaving remote system from making
+ * the app allocate huge amounts of memory. The default is 16 megabytes.
+ *
+ * \param sock the stream socket to change.
+ * \param maxlen the largest message to accept, in bytes, or zero to use the
+ *               default.
+ * \returns true on success, false on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_ReceiveMessage
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_SetStreamSocketMaxMessageSize(NET_StreamSocket *sock, int maxlen);
+
 /**
  * Enable simulated stream socket failures.
  *
@@ -1221,6 +2083,32 @@ extern SDL_DECLSPEC void SDLCALL NET_DestroyStreamSocket(NET_StreamSocket *sock)
  */
 typedef struct NET_DatagramSocket NET_DatagramSocket;
 
+/**
+ * Explicit Congestion Notification (ECN) codepoints.
+ *
+ * These are the two ECN bits in a packet's IP header. A sender marks packets
+ * as ECN-capable (ECT(0) or ECT(1)), and routers that are starting to get
+ * congested can change the marking to CE ("congestion experienced") instead
+ * of dropping the packet. A receiver that sees CE marks can tell the sender
+ * to slow down before the network starts losing packets.
+ *
+ * Datagram sockets are not a congestion-controlled protocol, so the library
+ * doesn't do anything with these itself; they are for apps that implement
+ * their own congestion control on top of datagrams.
+ *
+ * \since This enum is available since SDL_net 3.4.0.
+ *
+ * \sa NET_SetDatagramSocketECN
+ * \sa NET_Datagram
+ */
+typedef enum NET_ECN
+{
+    NET_ECN_NOT_ECT = 0,  /**< Not ECN-capable; routers will drop this packet instead of marking it. */
+    NET_ECN_ECT_1 = 1,    /**< ECN-capable transport, codepoint ECT(1). */
+    NET_ECN_ECT_0 = 2,    /**< ECN-capable transport, codepoint ECT(0). Most senders use this one. */
+    NET_ECN_CE = 3        /**< Congestion experienced; a router marked this packet instead of dropping it. */
+} NET_ECN;
+
 /**
  * The data provided for new incoming packets from NET_ReceiveDatagram().
  *
@@ -1235,6 +2123,8 @@ typedef struct NET_Datagram
     Uint16 port;  /**< Sender's port. These do not have to come from the same port the receiver is bound to. These are in host byte order, don't byteswap them! */
     Uint8 *buf;  /**< the payload of this datagram. */
     int buflen;  /**< the number of bytes available at `buf`. */
+    SDL_Time timestamp;  /**< When this packet reached this machine, on the same clock as SDL_GetCurrentTime(), if NET_PROP_DATAGRAM_SOCKET_TIMESTAMPS_BOOLEAN was set and the system reported it. Zero otherwise. (Available since SDL_net 3.4.0.) */
+    NET_ECN ecn;  /**< The packet's ECN marking, if NET_PROP_DATAGRAM_SOCKET_RECEIVE_ECN_BOOLEAN was set and the system reported it. NET_ECN_NOT_ECT otherwise. (Available since SDL_net 3.4.0.) */
 } NET_Datagram;
 
 /**
@@ -1306,6 +2196,62 @@ typedef struct NET_Datagram
  *   omit it, as it defaults to false. Note: IPv4 will still be able to
  *   receive broadcast packets without this option, but IPv6 will not. Also
  *   see notes about sending to a broadcast address in NET_SendDatagram().
+ * - `NET_PROP_DATAGRAM_SOCKET_REUSEPORT_BOOLEAN`: true if several datagram
+ *   sockets should be allowed to bind to the same address and port at the
+ *   same time, with the operating system spreading incoming packets between
+ *   them. This sets `SO_REUSEPORT` (or `SO_REUSEPORT_LB` on FreeBSD) on the
+ *   socket. Every socket sharing the port must set this property, and `port`
+ *   must not be zero. This is how an app can receive and reply to datagrams
+ *   on multiple CPU cores: create one datagram socket per worker thread, each
+ *   with this property set, and have each thread receive from, and reply
+ *   through, its own socket. On Linux, packets are distributed by hashing
+ *   each sender's address and port, so a given remote peer will usually keep
+ *   arriving at the same socket. Other platforms might not distribute packets
+ *   evenly, or at all. This property defaults to false. If it is true on a
+ *   platform that doesn't support `SO_REUSEPORT` (such as Windows), socket
+ *   creation will fail and this function will report an error.
+ * - `NET_PROP_DATAGRAM_SOCKET_GRO_BOOLEAN`: true if the system should be
+ *   allowed to merge runs of same-sized packets from the same sender into one
+ *   large buffer before the library receives them. On Linux, this sets
+ *   `UDP_GRO`, which can greatly reduce the cost of receiving at high packet
+ *   rates. This is invisible to the app: NET_ReceiveDatagram() still returns
+ *   each original packet separately, splitting the merged buffer up as the
+ *   app asks for more. This property defaults to false, and is quietly
+ *   ignored on platforms that don't support it.
+ * - `NET_PROP_DATAGRAM_SOCKET_MULTICAST_TTL_NUMBER`: the number of network
+ *   hops multicast packets sent from this socket may take before they are
+ *   discarded, from 0 to 255. This sets `IP_MULTICAST_TTL` for IPv4 and
+ *   `IPV6_MULTICAST_HOPS` for IPv6. The system default is usually 1, which
+ *   keeps multicast packets on the local network. If not specified, the
+ *   system default is used.
+ * - `NET_PROP_DATAGRAM_SOCKET_MULTICAST_LOOPBACK_BOOLEAN`: true if multicast
+ *   packets sent from this socket should also be delivered to sockets on
+ *   this machine that joined the group, false if not. This sets
+ *   `IP_MULTICAST_LOOP` for IPv4 and `IPV6_MULTICAST_LOOP` for IPv6. If not
+ *   specified, the system default (usually true) is used.
+ * - `NET_PROP_DATAGRAM_SOCKET_TIMESTAMPS_BOOLEAN`: true if the system should
+ *   record the time each packet arrived, which is then reported in
+ *   NET_Datagram's `timestamp` field. This is the time the packet reached
+ *   this machine, not the time the app called NET_ReceiveDatagram(), which
+ *   makes it useful for measuring latency and jitter. On Linux, this sets
+ *   `SO_TIMESTAMPNS`. This property defaults to false. On platforms that
+ *   don't support it, `timestamp` will be zero.
+ * - `NET_PROP_DATAGRAM_SOCKET_SEND_BUFFER_SIZE_NUMBER`: the size, in bytes,
+ *   of the system's send buffer for this socket (`SO_SNDBUF`). Systems may
+ *   round or limit this value; on Linux, `SO_SNDBUFFORCE` is tried first, so
+ *   privileged processes can exceed the system-wide limit.
+ * - `NET_PROP_DATAGRAM_SOCKET_RECEIVE_BUFFER_SIZE_NUMBER`: the size, in bytes,
+ *   of the system's receive buffer for this socket (`SO_RCVBUF`). Packets
+ *   that arrive while this buffer is full are dropped, so apps that receive
+ *   bursts of traffic might want to raise it. Systems may round or limit this
+ *   value; on Linux, `SO_RCVBUFFORCE` is tried first, so privileged processes
+ *   can exceed the system-wide limit. NET_GetDatagramSocketBufferSizes()
+ *   reports what the system actually chose.
+ * - `NET_PROP_DATAGRAM_SOCKET_RECEIVE_ECN_BOOLEAN`: true if the system should
+ *   report the ECN marking of each received packet, in NET_Datagram's `ecn`
+ *   field. On Linux, this sets `IP_RECVTOS` for IPv4 and `IPV6_RECVTCLASS`
+ *   for IPv6. This property defaults to false. On platforms that don't
+ *   support it, `ecn` will always be NET_ECN_NOT_ECT.
  *
  * \param addr the local address to listen for connections on, or NULL to
  *             listen on all available local addresses.
@@ -1326,6 +2272,225 @@ extern SDL_DECLSPEC NET_DatagramSocket * SDLCALL NET_CreateDatagramSocket(NET_Ad
 
 #define NET_PROP_DATAGRAM_SOCKET_REUSEADDR_BOOLEAN         "NET.datagram_socket.reuseaddr"
 #define NET_PROP_DATAGRAM_SOCKET_ALLOW_BROADCAST_BOOLEAN   "NET.datagram_socket.allow_broadcast"
+#define NET_PROP_DATAGRAM_SOCKET_REUSEPORT_BOOLEAN         "NET.datagram_socket.reuseport"
+#define NET_PROP_DATAGRAM_SOCKET_GRO_BOOLEAN               "NET.datagram_socket.gro"
+#define NET_PROP_DATAGRAM_SOCKET_MULTICAST_TTL_NUMBER      "NET.datagram_socket.multicast_ttl"
+#define NET_PROP_DATAGRAM_SOCKET_MULTICAST_LOOPBACK_BOOLEAN "NET.datagram_socket.multicast_loopback"
+#define NET_PROP_DATAGRAM_SOCKET_TIMESTAMPS_BOOLEAN        "NET.datagram_socket.timestamps"
+#define NET_PROP_DATAGRAM_SOCKET_SEND_BUFFER_SIZE_NUMBER   "NET.datagram_socket.send_buffer_size"
+#define NET_PROP_DATAGRAM_SOCKET_RECEIVE_BUFFER_SIZE_NUMBER "NET.datagram_socket.receive_buffer_size"
+#define NET_PROP_DATAGRAM_SOCKET_RECEIVE_ECN_BOOLEAN       "NET.datagram_socket.receive_ecn"
+
+/**
+ * Associate a datagram socket with a single remote peer.
+ *
+ * Many apps, like a game client, only ever exchange packets with one server.
+ * This tells the system about that peer up front, so it doesn't have to
+ * figure out where each packet is going (or where it came from) every time.
+ * This can make sending and receiving noticeably cheaper.
+ *
+ * Once connected, the socket only receives packets from this peer; packets
+ * from anywhere else are discarded by the system. Every packet received from
+ * the peer will report the same NET_Address object, `address`, and sending
+ * to that address (or one that NET_CompareAddresses() says is equal) and
+ * `port` skips the usual per-packet address lookup. Sending to other
+ * addresses might fail on some platforms, so apps should only talk to the
+ * connected peer.
+ *
+ * Unlike stream sockets, nothing is sent over the network by this call; it
+ * completes immediately, and doesn't tell you if anything is actually
+ * listening at the remote address.
+ *
+ * A datagram socket bound to all local addresses (created with a NULL
+ * address) only connects its socket for the peer's network family (IPv4 or
+ * IPv6); sockets for other families keep working as usual.
+ *
+ * Connecting to a NULL address removes an existing association, and the
+ * socket goes back to receiving packets from anywhere.
+ *
+ * \param sock the datagram socket to connect.
+ * \param address the remote peer's address, which must already be resolved,
+ *                or NULL to disconnect.
+ * \param port the remote peer's port.
+ * \returns true on success, false on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_CreateDatagramSocket
+ * \sa NET_SendDatagram
+ * \sa NET_ReceiveDatagram
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_ConnectDatagramSocket(NET_DatagramSocket *sock, NET_Address *address, Uint16 port);
+
+/**
+ * Start receiving packets sent to a multicast group.
+ *
+ * Multicast packets are sent to a special group address (224.0.0.0/4 for
+ * IPv4, ff00::/8 for IPv6), and the network delivers a copy to every socket
+ * that has joined that group. One send can reach any number of receivers,
+ * without the sender having to know who they are, and unlike broadcasts,
+ * machines that didn't join the group don't have to deal with the packets.
+ *
+ * Anyone can send to a multicast group with NET_SendDatagram(); joining is
+ * only needed to receive. A socket bound to a specific local address sends
+ * its multicast packets through that address's network interface; otherwise
+ * the system chooses one. To receive, the socket should be bound to the port
+ * the group's packets are sent to, and usually to all local addresses (a
+ * NULL address in NET_CreateDatagramSocket()), since the packets are
+ * addressed to the group, not to any local interface.
+ *
+ * If `source` is not NULL, this joins the group for packets from that one
+ * sender only ("source-specific multicast"). The same group may be joined
+ * several times with different sources. Not every platform or network
+ * supports this.
+ *
+ * If `iface` is not NULL, it must be one of the addresses reported by
+ * NET_GetLocalAddresses(), and the group is joined on that network interface.
+ * Otherwise, the system chooses an interface.
+ *
+ * The group (and source, and interface, if specified) must be resolved and
+ * use the same network family as each other.
+ *
+ * \param sock the datagram socket that should receive the group's packets.
+ * \param group the multicast group address to join.
+ * \param source the only address to receive the group's packets from, or
+ *               NULL for any.
+ * \param iface the local interface address to join on, or NULL to let the
+ *              system decide.
+ * \returns true on success, false on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_LeaveMulticastGroup
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_JoinMulticastGroup(NET_DatagramSocket *sock, NET_Address *group, NET_Address *source, NET_Address *iface);
+
+/**
+ * Stop receiving packets sent to a multicast group.
+ *
+ * The parameters must match a previous successful call to
+ * NET_JoinMulticastGroup(). Destroying the socket leaves all its groups, so
+ * this isn't necessary before calling NET_DestroyDatagramSocket().
+ *
+ * \param sock the datagram socket that joined the group.
+ * \param group the multicast group address to leave.
+ * \param source the source address the group was joined with, or NULL.
+ * \param iface the local interface address the group was joined on, or
+ *              NULL.
+ * \returns true on success, false on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_JoinMulticastGroup
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_LeaveMulticastGroup(NET_DatagramSocket *sock, NET_Address *group, NET_Address *source, NET_Address *iface);
+
+/**
+ * Query the sizes of a datagram socket's system buffers.
+ *
+ * These are the sizes the system actually uses, which might differ from
+ * what was requested with `NET_PROP_DATAGRAM_SOCKET_SEND_BUFFER_SIZE_NUMBER`
+ * and `NET_PROP_DATAGRAM_SOCKET_RECEIVE_BUFFER_SIZE_NUMBER`. Systems often
+ * limit these to a configurable maximum, and Linux reports double the size
+ * that was requested, to account for its own bookkeeping.
+ *
+ * \param sock the datagram socket to query.
+ * \param send_size on return, the send buffer size in bytes. May be NULL.
+ * \param receive_size on return, the receive buffer size in bytes. May be
+ *                     NULL.
+ * \returns true on success, false on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_CreateDatagramSocket
+ * \sa NET_GetDatagramSocketDroppedPackets
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_GetDatagramSocketBufferSizes(NET_DatagramSocket *sock, int *send_size, int *receive_size);
+
+/**
+ * Query how many incoming packets the system dropped because a datagram
+ * socket's receive buffer was full.
+ *
+ * When packets arrive faster than the app receives them, the system's
+ * receive buffer fills up and further packets are discarded before the app
+ * ever sees them. This count lets an app notice that happening, so it can
+ * receive more often or raise
+ * `NET_PROP_DATAGRAM_SOCKET_RECEIVE_BUFFER_SIZE_NUMBER`.
+ *
+ * The system reports this along with received packets, so the count only
+ * updates as the app calls NET_ReceiveDatagram(); it reflects drops up to the
+ * most recently received packet. Packets discarded by
+ * NET_SimulateDatagramPacketLoss() are not counted.
+ *
+ * This is currently only available on Linux (and Android), where it uses
+ * `SO_RXQ_OVFL`.
+ *
+ * \param sock the datagram socket to query.
+ * \returns the total number of packets dropped so far, or -1 on failure (or
+ *          if the platform can't report this); call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_GetDatagramSocketBufferSizes
+ */
+extern SDL_DECLSPEC Sint64 SDLCALL NET_GetDatagramSocketDroppedPackets(NET_DatagramSocket *sock);
+
+/**
+ * Set the ECN marking for packets sent from a datagram socket.
+ *
+ * This affects every packet sent from the socket after this call, including
+ * packets that are already queued but not yet sent. Apps that want to mark
+ * individual packets differently can change this between sends.
+ *
+ * This sets the low two bits of `IP_TOS` for IPv4 and `IPV6_TCLASS` for
+ * IPv6, leaving the rest of those values alone. Not every platform honors
+ * this (Windows, in particular, ignores it), and networks along the way may
+ * clear the marking.
+ *
+ * \param sock the datagram socket to change.
+ * \param ecn the ECN codepoint to mark outgoing packets with. Apps should
+ *            generally only use NET_ECN_NOT_ECT, NET_ECN_ECT_0, or
+ *            NET_ECN_ECT_1.
+ * \returns true on success, false on failure; call SDL_GetError() for
+ *          details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_ECN
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_SetDatagramSocketECN(NET_DatagramSocket *sock, NET_ECN ecn);
 
 
 /**
@@ -1411,6 +2576,49 @@ extern SDL_DECLSPEC NET_DatagramSocket * SDLCALL NET_CreateDatagramSocket(NET_Ad
  */
 extern SDL_DECLSPEC bool SDLCALL NET_SendDatagram(NET_DatagramSocket *sock, NET_Address *address, Uint16 port, const void *buf, int buflen);
 
+/**
+ * Send a run of equal-sized packets from a datagram socket in one call.
+ *
+ * This splits `buf` into packets of `segment_size` bytes each (the last one
+ * may be shorter) and sends them all to the same destination, exactly as if
+ * NET_SendDatagram() had been called once per packet. The receiver sees
+ * separate packets; nothing is reassembled on the other side.
+ *
+ * This is useful for apps that send many packets to the same peer at once,
+ * like streaming a large file or a big state update. On platforms that
+ * support it (Linux's UDP Generic Segmentation Offload), the whole run is
+ * handed to the system in a few calls and split by the kernel or network
+ * hardware, which is significantly cheaper than sending each packet
+ * separately. Elsewhere, or if the system refuses, the library splits the
+ * packets itself.
+ *
+ * Like NET_SendDatagram(), this call never blocks; anything that can't be
+ * sent immediately is queued for later transmission, one packet at a time.
+ *
+ * Sending to a NULL address broadcasts each packet, with the same caveats as
+ * NET_SendDatagram(). Broadcasts are never offloaded.
+ *
+ * \param sock the datagram socket to send data through.
+ * \param address the NET_Address object address. May be NULL to broadcast.
+ * \param port the address port.
+ * \param buf a pointer to the data to send.
+ * \param buflen the size of the data to send, in bytes.
+ * \param segment_size the size of each packet, in bytes. Must be between 1
+ *                     and 65507, the largest payload a UDP packet can carry.
+ * \returns true if data sent or queued for transmission, false on failure;
+ *          call SDL_GetError() for details.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_SendDatagram
+ */
+extern SDL_DECLSPEC bool SDLCALL NET_SendDatagramSegments(NET_DatagramSocket *sock, NET_Address *address, Uint16 port, const void *buf, int buflen, int segment_size);
+
 /**
  * Receive a new packet that a remote system sent to a datagram socket.
  *
@@ -1575,6 +2783,14 @@ extern SDL_DECLSPEC void SDLCALL NET_DestroyDatagramSocket(NET_DatagramSocket *s
  * read from each of them and see which are ready. If nothing is ready and the
  * timeout is reached, this returns zero. On error, this returns -1.
  *
+ * While waiting, sockets that have data queued for sending will keep sending
+ * it as the network allows. This doesn't wake the app up for every bit of
+ * progress; instead, a stream or datagram socket that finishes sending all
+ * its pending data during the wait is counted in the return value, as if it
+ * had new input, so the app can decide if it wants to queue more. Sockets
+ * that fail while sending are also counted, so the app can find out about
+ * the failure from its next read or write.
+ *
  * \param vsockets an array of pointers to various objects that can be waited
  *                 on, each cast to a void pointer.
  * \param numsockets the number of pointers in the `vsockets` array.
@@ -1593,9 +2809,74 @@ extern SDL_DECLSPEC void SDLCALL NET_DestroyDatagramSocket(NET_DatagramSocket *s
  * \sa NET_CreateDatagramSocket
  * \sa NET_SendDatagram
  * \sa NET_ReceiveDatagram
+ * \sa NET_WaitUntilNewInputAvailable
  */
 extern SDL_DECLSPEC int SDLCALL NET_WaitUntilInputAvailable(void **vsockets, int numsockets, Sint32 timeout);
 
+/**
+ * Block on multiple sockets until at least one has _new_ data available.
+ *
+ * This works like NET_WaitUntilInputAvailable(), but it is "edge-triggered"
+ * instead of "level-triggered": once a socket has been reported as having
+ * input by this function, it will not be reported again until the app has
+ * drained it, which is to say, until the app has read from it until there
+ * was nothing left to read. Until then, the library tracks the socket as
+ * still needing to be drained, and this function won't wake up for it.
+ *
+ * This is useful for apps that service busy sockets in batches: with
+ * NET_WaitUntilInputAvailable(), a socket that still has unread data will
+ * make every wait return immediately, even if the app has decided to deal
+ * with that socket later. With this function, the app is only woken for
+ * sockets that have new input it hasn't been told about.
+ *
+ * A socket is considered drained when:
+ *
+ * - NET_Server: NET_AcceptClient() reported no new connections.
+ * - NET_StreamSocket: NET_ReadFromStreamSocket() returned zero because no
+ *   data was available.
+ * - NET_DatagramSocket: NET_ReceiveDatagram() reported no new packets.
+ *
+ * Stream socket data that the library has already read ahead into its own
+ * buffer (see NET_PeekFromStreamSocket()) is reported once, and again each
+ * time the app consumes some of it and leaves the rest, unless the app is
+ * waiting on NET_ReadFromStreamSocketUntil() or
+ * NET_ReadExactFromStreamSocket() to get more data first.
+ *
+ * It is the app's responsibility to remember which sockets were reported and
+ * service them until they are drained; if it doesn't, it will not be told
+ * about those sockets again, even as more data arrives on them.
+ *
+ * Sockets that are still waiting for pending output to be sent will continue
+ * to send it while this function blocks, whether they have been drained or
+ * not. Stream sockets that finish connecting are reported by this function
+ * without needing to be drained first.
+ *
+ * Sockets only track whether they need to be drained for this function;
+ * NET_WaitUntilInputAvailable() ignores this state and reports all sockets
+ * with any input available, as usual.
+ *
+ * \param vsockets an array of pointers to various objects that can be waited
+ *                 on, each cast to a void pointer.
+ * \param numsockets the number of pointers in the `vsockets` array.
+ * \param timeout Number of milliseconds to wait for new input to become
+ *                available. -1 to wait indefinitely, 0 to check once without
+ *                waiting.
+ * \returns the number of items that have new input, or -1 on error.
+ *
+ * \threadsafety You should not operate on the same socket from multiple
+ *               threads at the same time without supplying a serialization
+ *               mechanism. However, different threads may access different
+ *               sockets at the same time without problems.
+ *
+ * \since This function is available since SDL_net 3.4.0.
+ *
+ * \sa NET_WaitUntilInputAvailable
+ * \sa NET_AcceptClient
+ * \sa NET_ReadFromStreamSocket
+ * \sa NET_ReceiveDatagram
+ */
+extern SDL_DECLSPEC int SDLCALL NET_WaitUntilNewInputAvailable(void **vsockets, int numsockets, Sint32 timeout);
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
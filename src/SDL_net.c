@@ -30,6 +30,10 @@
 #endif
 #endif /* _WIN32 */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE 1  // for accept4().
+#endif
+
 #include "SDL3_net/SDL_net.h"
 
 #ifdef SDL_PLATFORM_WINDOWS
@@ -37,6 +41,7 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <iphlpapi.h>
+#include <string.h>
 typedef SOCKET Socket;
 typedef int SockLen;
 typedef SOCKADDR_STORAGE AddressStorage;
@@ -65,9 +70,13 @@ static int WindowsPoll(struct pollfd *fds, unsigned int nfds, int timeout)
     SDL_assert(fds != NULL);
     SDL_assert(nfds > 0);
 
-    int nreadfds = 0, nwritefds = 0, nexceptfds = nfds;
+    int nreadfds = 0, nwritefds = 0, nexceptfds = 0;
     for (unsigned int i = 0; i < nfds; i++) {
         fds[i].revents = 0;
+        if (fds[i].fd == INVALID_SOCKET) {
+            continue;  // poll() ignores negative file descriptors, so we ignore invalid sockets.
+        }
+        nexceptfds++;
         if (fds[i].events & POLLIN) {
             nreadfds++;
         }
@@ -115,8 +124,14 @@ static int WindowsPoll(struct pollfd *fds, unsigned int nfds, int timeout)
     #undef ALLOC_FDSET
 
     int retval = -1;
-    if (!failed) {
+    if (!failed && (nexceptfds == 0)) {  // select() fails if there are no sockets at all, so just sleep.
+        Sleep((timeout < 0) ? INFINITE : (DWORD) timeout);  // this is what poll() would do, too.
+        retval = 0;
+    } else if (!failed) {
         for (unsigned int i = 0; i < nfds; i++) {
+            if (fds[i].fd == INVALID_SOCKET) {
+                continue;
+            }
             exceptfds->sockets[exceptfds->count++] = fds[i].fd;
             if (fds[i].events & POLLIN) {
                 readfds->sockets[readfds->count++] = fds[i].fd;
@@ -172,7 +187,9 @@ static int WindowsPoll(struct pollfd *fds, unsigned int nfds, int timeout)
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #ifndef SDL_PLATFORM_VITA
+#include <netinet/tcp.h>
 #include <net/if.h>
+#include <sys/uio.h>
 #endif
 #include <netdb.h>
 #include <errno.h>
@@ -184,8 +201,46 @@ static int WindowsPoll(struct pollfd *fds, unsigned int nfds, int timeout)
 
 #if defined(SDL_PLATFORM_LINUX) || defined(SDL_PLATFORM_ANDROID)
 #define USE_NETLINK 1
+#define USE_SENDFILE 1
+#define USE_ZEROCOPY 1
+#define USE_ACCEPT4 1
+#define USE_UDP_SEGMENT 1
+#define USE_UDP_GRO 1
+#define USE_RECVMSG 1
+#define USE_SO_TIMESTAMPNS 1
+#define USE_SENDMMSG 1
+#define USE_SO_RXQ_OVFL 1
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
+#include <linux/errqueue.h>
+#include <sys/sendfile.h>
+#ifndef SO_ZEROCOPY  // these are newer than some C runtime headers, but the kernel will tell us if it doesn't support them.
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef TCP_FASTOPEN
+#define TCP_FASTOPEN 23
+#endif
+#ifndef TCP_FASTOPEN_CONNECT
+#define TCP_FASTOPEN_CONNECT 30
+#endif
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL 40
+#endif
 #endif
 
 #ifdef HAVE_GETIFADDRS
@@ -226,6 +281,7 @@ struct NET_Address
     SDL_AtomicInt refcount;
     SDL_AtomicInt status;  // This is actually a NET_Status.
     struct addrinfo *ainfo;
+    bool ainfo_is_ours;  // ainfo is a NET_SockAddrInfo we built ourselves, not something from getaddrinfo().
     NET_Address *resolver_next;  // a linked list for the resolution job queue.
 };
 
@@ -257,6 +313,7 @@ static SDL_RWLock *interface_rwlock = NULL;
 static int num_interfaces = 0;
 static NetworkInterface *interfaces = NULL;
 static SDL_AtomicInt interfaces_have_changed;
+static SDL_AtomicInt interfaces_generation;  // bumped on every refresh, so things built from the interface list can tell they're stale.
 
 // Other stuff...
 static NET_Address *ipv6_broadcast_addr = NULL;
@@ -353,12 +410,6 @@ static int SetGetAddrInfoError(const char *msg, int err)
     return -1;
 }
 
-static bool SetGetAddrInfoErrorBool(const char *msg, int err)
-{
-    SetGetAddrInfoError(msg, err);
-    return false;
-}
-
 static int MakeSocketNonblocking(Socket handle)
 {
     #ifdef SDL_PLATFORM_WINDOWS
@@ -369,6 +420,26 @@ static int MakeSocketNonblocking(Socket handle)
     #endif
 }
 
+// let multiple sockets bind to the same address and port, with the OS spreading incoming traffic between them.
+static bool EnableReusePort(Socket handle)
+{
+    #if defined(SO_REUSEPORT_LB)  // FreeBSD's SO_REUSEPORT doesn't load-balance, but this does.
+    const int one = 1;
+    if (setsockopt(handle, SOL_SOCKET, SO_REUSEPORT_LB, (const char *) &one, sizeof (one)) == SOCKET_ERROR) {
+        return SetSocketErrorBool("Failed to enable SO_REUSEPORT_LB", LastSocketError());
+    }
+    return true;
+    #elif defined(SO_REUSEPORT)
+    const int one = 1;
+    if (setsockopt(handle, SOL_SOCKET, SO_REUSEPORT, (const char *) &one, sizeof (one)) == SOCKET_ERROR) {
+        return SetSocketErrorBool("Failed to enable SO_REUSEPORT", LastSocketError());
+    }
+    return true;
+    #else
+    return SDL_SetError("SO_REUSEPORT is not supported on this platform");
+    #endif
+}
+
 static bool WouldBlock(const int err)
 {
     #ifdef SDL_PLATFORM_WINDOWS
@@ -378,6 +449,121 @@ static bool WouldBlock(const int err)
     #endif
 }
 
+// most buffers we'll hand to a single writev() call; anything past this just waits for the next write.
+#define MAX_IOVECS_PER_SYSCALL 64
+
+// write several buffers with one system call. Returns bytes written or -1, like write().
+static int SocketWriteV(Socket handle, const NET_IOVec *iov, int iovcnt)
+{
+    if (iovcnt == 1) {
+        return (int) write(handle, iov[0].buf, iov[0].buflen);
+    }
+
+    iovcnt = SDL_min(iovcnt, MAX_IOVECS_PER_SYSCALL);
+
+    #ifdef SDL_PLATFORM_WINDOWS
+    WSABUF wsabufs[MAX_IOVECS_PER_SYSCALL];
+    for (int i = 0; i < iovcnt; i++) {
+        wsabufs[i].buf = (CHAR *) iov[i].buf;
+        wsabufs[i].len = (ULONG) iov[i].buflen;
+    }
+    DWORD count_sent = 0;
+    if (WSASend(handle, wsabufs, (DWORD) iovcnt, &count_sent, 0, NULL, NULL) != 0) {
+        return -1;
+    }
+    return (int) count_sent;
+    #elif defined(SDL_PLATFORM_VITA)  // no writev() here, so just write each piece until one comes up short.
+    int total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        const int bw = (int) write(handle, iov[i].buf, iov[i].buflen);
+        if (bw < 0) {
+            return (total > 0) ? total : -1;
+        }
+        total += bw;
+        if (bw < iov[i].buflen) {
+            break;
+        }
+    }
+    return total;
+    #else
+    struct iovec iovecs[MAX_IOVECS_PER_SYSCALL];
+    for (int i = 0; i < iovcnt; i++) {
+        iovecs[i].iov_base = iov[i].buf;
+        iovecs[i].iov_len = (size_t) iov[i].buflen;
+    }
+    return (int) writev(handle, iovecs, iovcnt);
+    #endif
+}
+
+// read into several buffers with one system call. Returns bytes read or -1, like read().
+static int SocketReadV(Socket handle, const NET_IOVec *iov, int iovcnt)
+{
+    if (iovcnt == 1) {
+        return (int) read(handle, (char *) iov[0].buf, iov[0].buflen);
+    }
+
+    iovcnt = SDL_min(iovcnt, MAX_IOVECS_PER_SYSCALL);
+
+    #ifdef SDL_PLATFORM_WINDOWS
+    WSABUF wsabufs[MAX_IOVECS_PER_SYSCALL];
+    for (int i = 0; i < iovcnt; i++) {
+        wsabufs[i].buf = (CHAR *) iov[i].buf;
+        wsabufs[i].len = (ULONG) iov[i].buflen;
+    }
+    DWORD count_received = 0;
+    DWORD flags = 0;
+    if (WSARecv(handle, wsabufs, (DWORD) iovcnt, &count_received, &flags, NULL, NULL) != 0) {
+        return -1;
+    }
+    return (int) count_received;
+    #elif defined(SDL_PLATFORM_VITA)  // no readv() here, so just read each piece until one comes up short.
+    int total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        const int br = (int) read(handle, iov[i].buf, iov[i].buflen);
+        if (br < 0) {
+            return (total > 0) ? total : -1;
+        }
+        total += br;
+        if (br < iov[i].buflen) {
+            break;
+        }
+    }
+    return total;
+    #else
+    struct iovec iovecs[MAX_IOVECS_PER_SYSCALL];
+    for (int i = 0; i < iovcnt; i++) {
+        iovecs[i].iov_base = iov[i].buf;
+        iovecs[i].iov_len = (size_t) iov[i].buflen;
+    }
+    return (int) readv(handle, iovecs, iovcnt);
+    #endif
+}
+
+// check an app-supplied array of buffers, and return the total bytes they hold (-1 on error).
+static int GetIOVecTotalLength(const NET_IOVec *iov, int iovcnt)
+{
+    if (iovcnt < 0) {
+        SDL_InvalidParamError("iovcnt");
+        return -1;
+    } else if (!iov && (iovcnt > 0)) {
+        SDL_InvalidParamError("iov");
+        return -1;
+    }
+
+    int total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if ((iov[i].buflen < 0) || (!iov[i].buf && (iov[i].buflen > 0))) {
+            SDL_InvalidParamError("iov");
+            return -1;
+        } else if (iov[i].buflen > (SDL_MAX_SINT32 - total)) {
+            SDL_SetError("Too much data in one operation");
+            return -1;
+        }
+        total += iov[i].buflen;
+    }
+    return total;
+}
+
 static NET_Address *CreateSDLNetAddrFromSockAddr(const struct sockaddr *saddr, SockLen saddrlen);
 
 
@@ -987,6 +1173,7 @@ static bool InterfacesReady(void)
     // if there were changes, mark it as unchanged and then we'll enumerate. So if it changes again while enumerating, we'll pick that up next time.
     if (SDL_CompareAndSwapAtomicInt(&interfaces_have_changed, 1, 0)) {
         RefreshInterfaces();
+        SDL_AddAtomicInt(&interfaces_generation, 1);
         #if 0
         SDL_Log("NETWORK INTERFACE REFRESH");
         SDL_LockRWLockForReading(interface_rwlock);
@@ -1120,7 +1307,9 @@ static SDL_Thread *SpinResolverThread(const int num)
 static void DestroyAddress(NET_Address *addr)
 {
     if (addr) {
-        if (addr->ainfo) {
+        if (addr->ainfo_is_ours) {
+            SDL_free(addr->ainfo);
+        } else if (addr->ainfo) {
             freeaddrinfo(addr->ainfo);
         }
         SDL_free(addr->hostname);
@@ -1130,8 +1319,77 @@ static void DestroyAddress(NET_Address *addr)
     }
 }
 
+// an addrinfo and the sockaddr it points to, in one allocation.
+typedef struct NET_SockAddrInfo
+{
+    struct addrinfo ainfo;
+    AddressStorage storage;
+} NET_SockAddrInfo;
+
+// build an address straight from an IPv4 or IPv6 sockaddr, without a round trip through getnameinfo() and
+//  getaddrinfo(). This is the hot path for accepting connections. Returns NULL, without setting an error, if this
+//  address needs the slow path instead.
+static NET_Address *CreateSDLNetAddrFromInetSockAddr(const struct sockaddr *saddr, SockLen saddrlen)
+{
+    #ifdef SDL_PLATFORM_VITA
+    return NULL;
+    #else
+    const void *rawaddr;
+    SockLen addrlen;
+    if ((saddr->sa_family == AF_INET) && (saddrlen >= (SockLen) sizeof (struct sockaddr_in))) {
+        rawaddr = &((const struct sockaddr_in *) saddr)->sin_addr;
+        addrlen = (SockLen) sizeof (struct sockaddr_in);
+    } else if ((saddr->sa_family == AF_INET6) && (saddrlen >= (SockLen) sizeof (struct sockaddr_in6)) && (((const struct sockaddr_in6 *) saddr)->sin6_scope_id == 0)) {
+        rawaddr = &((const struct sockaddr_in6 *) saddr)->sin6_addr;
+        addrlen = (SockLen) sizeof (struct sockaddr_in6);
+    } else {
+        return NULL;  // let getnameinfo() deal with it (scoped IPv6 addresses need a "%interface" suffix, etc).
+    }
+
+    char hostbuf[INET6_ADDRSTRLEN];
+    if (!inet_ntop(saddr->sa_family, rawaddr, hostbuf, sizeof (hostbuf))) {
+        return NULL;
+    }
+
+    NET_Address *addr = (NET_Address *) SDL_calloc(1, sizeof (NET_Address));
+    NET_SockAddrInfo *info = (NET_SockAddrInfo *) SDL_calloc(1, sizeof (NET_SockAddrInfo));
+    char *human_readable = SDL_strdup(hostbuf);
+    if (!addr || !info || !human_readable) {
+        SDL_free(addr);
+        SDL_free(info);
+        SDL_free(human_readable);
+        return NULL;
+    }
+
+    // match what getaddrinfo() would have given us for this numeric host with SOCK_DGRAM and no service.
+    SDL_memcpy(&info->storage, saddr, addrlen);
+    if (saddr->sa_family == AF_INET) {
+        ((struct sockaddr_in *) &info->storage)->sin_port = 0;
+    } else {
+        ((struct sockaddr_in6 *) &info->storage)->sin6_port = 0;
+        ((struct sockaddr_in6 *) &info->storage)->sin6_flowinfo = 0;
+    }
+    info->ainfo.ai_family = saddr->sa_family;
+    info->ainfo.ai_socktype = SOCK_DGRAM;
+    info->ainfo.ai_protocol = IPPROTO_UDP;
+    info->ainfo.ai_addrlen = addrlen;
+    info->ainfo.ai_addr = (struct sockaddr *) &info->storage;
+
+    SDL_SetAtomicInt(&addr->status, (int) NET_SUCCESS);
+    addr->ainfo = &info->ainfo;
+    addr->ainfo_is_ours = true;
+    addr->human_readable = human_readable;
+    return NET_RefAddress(addr);
+    #endif
+}
+
 static NET_Address *CreateSDLNetAddrFromSockAddr(const struct sockaddr *saddr, SockLen saddrlen)
 {
+    NET_Address *fastaddr = CreateSDLNetAddrFromInetSockAddr(saddr, saddrlen);
+    if (fastaddr) {
+        return fastaddr;
+    }
+
     // !!! FIXME: this all seems inefficient in the name of keeping addresses generic.
     char hostbuf[128];
     int gairc = getnameinfo(saddr, saddrlen, hostbuf, sizeof (hostbuf), NULL, 0, NI_NUMERICHOST);
@@ -1597,123 +1855,551 @@ struct NET_StreamSocket
     int pending_output_allocation;
     int percent_loss;
     Uint64 simulated_failure_until;
+    bool input_needs_drain;  // reported by NET_WaitUntilNewInputAvailable, but not read until it would block yet.
+    bool threadsafe_writes;  // if true, writes go through write_queue and pending output is only touched while holding pump_lock.
+    void *write_queue;  // (NET_StreamWriteNode *, atomic) writes from any thread not yet moved into pending_output_buffer, newest first.
+    SDL_AtomicInt write_queue_len;  // total bytes sitting in write_queue.
+    SDL_AtomicInt published_pending_output_len;  // pending_output_len as of the last time someone released pump_lock.
+    SDL_SpinLock pump_lock;
+    Socket wake_handle;  // in thread-safe mode, writers send a byte here to wake a thread that's blocked in poll() on this socket.
+    SDL_AtomicInt wake_needed;  // non-zero while a thread is in poll() on this socket without watching for writability.
+    SDL_AtomicInt corked;  // non-zero if writes should only queue up until the app flushes (or waits on the socket).
+    Uint8 *input_buffer;  // data read ahead by NET_PeekFromStreamSocket, etc, that the app hasn't consumed yet.
+    int input_buffer_start;  // offset of the first unconsumed byte in input_buffer.
+    int input_buffer_len;  // unconsumed bytes in input_buffer, starting at input_buffer_start.
+    int input_buffer_allocation;
+    int input_error;  // failure hit while filling input_buffer, held until it's empty: 0 for none, -1 for end of stream, else a socket error code.
+    bool input_buffer_needs_more;  // the app has looked at everything in input_buffer and can't proceed until more arrives.
+    bool input_buffer_reported;  // NET_WaitUntilNewInputAvailable reported input_buffer, and it hasn't changed since.
+    int max_message_size;  // largest message NET_ReceiveMessage will accept; zero for DEFAULT_MAX_MESSAGE_SIZE.
+    struct NET_PendingRange *pending_ranges;  // file ranges and zero-copy buffers still to send, in order.
+    struct NET_PendingRange *pending_ranges_tail;
+    Sint64 pending_range_bytes;  // total bytes left in pending_ranges.
+    int zerocopy_state;  // 0 if we haven't tried MSG_ZEROCOPY yet, 1 if it's enabled, -1 if it isn't available.
+    Uint32 zerocopy_sends;  // MSG_ZEROCOPY send() calls the kernel has accepted; the kernel numbers completions the same way.
+    Uint32 zerocopy_completed;  // every MSG_ZEROCOPY send() numbered below this has finished with its buffer.
+    Sint64 zerocopy_last_id;  // id of the most recent NET_WriteToStreamSocketZeroCopy call.
+    Sint64 zerocopy_completed_id;  // every zero-copy write with this id or lower has finished with its buffer.
+    struct NET_ZeroCopyWrite *zerocopy_writes;  // zero-copy writes that aren't finished yet, oldest first.
+    struct NET_ZeroCopyWrite *zerocopy_writes_tail;
+    struct NET_ConnectRace *race;  // non-NULL while racing connections to several addresses; `handle` is invalid until one wins.
 };
 
-NET_StreamSocket *NET_CreateClient(NET_Address *addr, Uint16 port, SDL_PropertiesID props)
+// a zero-copy write that the app can't reuse the buffer for yet.
+typedef struct NET_ZeroCopyWrite
 {
-    if (addr == NULL) {
-        SDL_InvalidParamError("address");
-        return NULL;
-    } else if (((NET_Status) SDL_GetAtomicInt(&addr->status)) != NET_SUCCESS) {
-        SDL_SetError("Address is not resolved");
-        return NULL;
+    struct NET_ZeroCopyWrite *next;
+    Sint64 id;
+    bool issued;  // all its data has been handed to the kernel (or copied into our own buffers).
+    bool pinned;  // at least one MSG_ZEROCOPY send() used it, so it's not finished until `last_send` completes.
+    Uint32 last_send;  // number of the last MSG_ZEROCOPY send() that used it.
+} NET_ZeroCopyWrite;
+
+// data waiting to go out through a stream socket that never gets copied into pending_output_buffer: part of a
+//  file, or an app buffer from a zero-copy write.
+typedef struct NET_PendingRange
+{
+    struct NET_PendingRange *next;
+    SDL_IOStream *io;  // NULL if this is a zero-copy write.
+    bool closeio;
+    int fd;  // file descriptor behind `io` for sendfile(), or -1 to read it through `io`.
+    const Uint8 *buf;  // the app's buffer for zero-copy writes.
+    NET_ZeroCopyWrite *zerocopy;  // the zero-copy write this belongs to.
+    Sint64 offset;
+    Sint64 remaining;
+    int buffer_pos;  // this range goes out after this many more bytes of pending_output_buffer are sent.
+} NET_PendingRange;
+
+// a write made to a socket in thread-safe mode; the data follows this struct in the same allocation.
+typedef struct NET_StreamWriteNode
+{
+    struct NET_StreamWriteNode *next;
+    int len;
+} NET_StreamWriteNode;
+
+// tuning options for stream sockets, from NET_PROP_STREAM_SOCKET_* properties. -1 means "leave the system default alone."
+typedef struct NET_StreamSocketOptions
+{
+    int nodelay;
+    int send_buffer_size;
+    int receive_buffer_size;
+    int quickack;
+    int notsent_lowat;
+    int keepalive;
+    int keepalive_idle;
+    int keepalive_interval;
+    int keepalive_count;
+    int tos;
+    int priority;
+    int fastopen_connect;  // clients only; set by NET_CreateClient, not GetStreamSocketOptions.
+} NET_StreamSocketOptions;
+
+static int GetOptionalBooleanProperty(SDL_PropertiesID props, const char *name)
+{
+    return SDL_HasProperty(props, name) ? (SDL_GetBooleanProperty(props, name, false) ? 1 : 0) : -1;
+}
+
+static int GetOptionalNumberProperty(SDL_PropertiesID props, const char *name)
+{
+    const Sint64 value = SDL_GetNumberProperty(props, name, -1);
+    return (value < 0) ? -1 : (int) SDL_min(value, SDL_MAX_SINT32);
+}
+
+static void GetStreamSocketOptions(SDL_PropertiesID props, NET_StreamSocketOptions *opts)
+{
+    opts->nodelay = GetOptionalBooleanProperty(props, NET_PROP_STREAM_SOCKET_NODELAY_BOOLEAN);
+    opts->send_buffer_size = GetOptionalNumberProperty(props, NET_PROP_STREAM_SOCKET_SEND_BUFFER_SIZE_NUMBER);
+    opts->receive_buffer_size = GetOptionalNumberProperty(props, NET_PROP_STREAM_SOCKET_RECEIVE_BUFFER_SIZE_NUMBER);
+    opts->quickack = GetOptionalBooleanProperty(props, NET_PROP_STREAM_SOCKET_QUICKACK_BOOLEAN);
+    opts->notsent_lowat = GetOptionalNumberProperty(props, NET_PROP_STREAM_SOCKET_NOTSENT_LOWAT_NUMBER);
+    opts->keepalive = GetOptionalBooleanProperty(props, NET_PROP_STREAM_SOCKET_KEEPALIVE_BOOLEAN);
+    opts->keepalive_idle = GetOptionalNumberProperty(props, NET_PROP_STREAM_SOCKET_KEEPALIVE_IDLE_NUMBER);
+    opts->keepalive_interval = GetOptionalNumberProperty(props, NET_PROP_STREAM_SOCKET_KEEPALIVE_INTERVAL_NUMBER);
+    opts->keepalive_count = GetOptionalNumberProperty(props, NET_PROP_STREAM_SOCKET_KEEPALIVE_COUNT_NUMBER);
+    opts->tos = GetOptionalNumberProperty(props, NET_PROP_STREAM_SOCKET_TOS_NUMBER);
+    opts->priority = GetOptionalNumberProperty(props, NET_PROP_STREAM_SOCKET_PRIORITY_NUMBER);
+    opts->fastopen_connect = -1;
+}
+
+static bool SetSocketOption(Socket handle, int level, int optname, int value, const char *errmsg)
+{
+    if ((value >= 0) && (setsockopt(handle, level, optname, (const char *) &value, sizeof (value)) == SOCKET_ERROR)) {
+        return SetSocketErrorBool(errmsg, LastSocketError());
     }
+    return true;
+}
 
-    NET_StreamSocket *sock = (NET_StreamSocket *) SDL_calloc(1, sizeof (NET_StreamSocket));
-    if (!sock) {
-        return NULL;
+// options that a platform doesn't have are quietly skipped; they're all just tuning.
+static bool ApplyStreamSocketOptions(Socket handle, int family, const NET_StreamSocketOptions *opts)
+{
+    #ifdef TCP_NODELAY
+    if (!SetSocketOption(handle, IPPROTO_TCP, TCP_NODELAY, opts->nodelay, "Failed to set TCP_NODELAY")) {
+        return false;
     }
+    #endif
 
-    sock->socktype = SOCKETTYPE_STREAM;
-    sock->addr = addr;
-    sock->port = port;
+    if (!SetSocketOption(handle, SOL_SOCKET, SO_SNDBUF, opts->send_buffer_size, "Failed to set SO_SNDBUF")) {
+        return false;
+    } else if (!SetSocketOption(handle, SOL_SOCKET, SO_RCVBUF, opts->receive_buffer_size, "Failed to set SO_RCVBUF")) {
+        return false;
+    }
 
-    // we need to set up a sockaddr with the port in it for connect(), which is kind of a pain, since we
-    // want to keep things generic and also not set up a port at resolve time.
-    struct addrinfo *addrwithport = MakeAddrInfoWithPort(addr, SOCK_STREAM, port);
-    if (!addrwithport) {
-        SDL_free(sock);
-        return NULL;
+    #ifdef TCP_QUICKACK
+    if (!SetSocketOption(handle, IPPROTO_TCP, TCP_QUICKACK, opts->quickack, "Failed to set TCP_QUICKACK")) {
+        return false;
     }
+    #endif
 
-    sock->handle = socket(addrwithport->ai_family, addrwithport->ai_socktype, addrwithport->ai_protocol);
-    if (sock->handle == INVALID_SOCKET) {
+    #ifdef TCP_NOTSENT_LOWAT
+    if (!SetSocketOption(handle, IPPROTO_TCP, TCP_NOTSENT_LOWAT, opts->notsent_lowat, "Failed to set TCP_NOTSENT_LOWAT")) {
+        return false;
+    }
+    #endif
+
+    if (!SetSocketOption(handle, SOL_SOCKET, SO_KEEPALIVE, opts->keepalive, "Failed to set SO_KEEPALIVE")) {
+        return false;
+    }
+
+    #if defined(TCP_KEEPIDLE)
+    if (!SetSocketOption(handle, IPPROTO_TCP, TCP_KEEPIDLE, opts->keepalive_idle, "Failed to set TCP_KEEPIDLE")) {
+        return false;
+    }
+    #elif defined(TCP_KEEPALIVE) && defined(SDL_PLATFORM_APPLE)  // Apple calls it this.
+    if (!SetSocketOption(handle, IPPROTO_TCP, TCP_KEEPALIVE, opts->keepalive_idle, "Failed to set TCP_KEEPALIVE")) {
+        return false;
+    }
+    #endif
+
+    #ifdef TCP_KEEPINTVL
+    if (!SetSocketOption(handle, IPPROTO_TCP, TCP_KEEPINTVL, opts->keepalive_interval, "Failed to set TCP_KEEPINTVL")) {
+        return false;
+    }
+    #endif
+
+    #ifdef TCP_KEEPCNT
+    if (!SetSocketOption(handle, IPPROTO_TCP, TCP_KEEPCNT, opts->keepalive_count, "Failed to set TCP_KEEPCNT")) {
+        return false;
+    }
+    #endif
+
+    if (family == AF_INET6) {
+        #ifdef IPV6_TCLASS
+        if (!SetSocketOption(handle, IPPROTO_IPV6, IPV6_TCLASS, opts->tos, "Failed to set IPV6_TCLASS")) {
+            return false;
+        }
+        #endif
+    } else {
+        #ifdef IP_TOS
+        if (!SetSocketOption(handle, IPPROTO_IP, IP_TOS, opts->tos, "Failed to set IP_TOS")) {
+            return false;
+        }
+        #endif
+    }
+
+    #ifdef SO_PRIORITY
+    if (!SetSocketOption(handle, SOL_SOCKET, SO_PRIORITY, opts->priority, "Failed to set SO_PRIORITY")) {
+        return false;
+    }
+    #endif
+
+    #ifdef TCP_FASTOPEN_CONNECT
+    if (opts->fastopen_connect > 0) {
+        // connect() returns right away, and the SYN goes out with the first write. Older kernels don't have this;
+        //  if this fails, oh well, we just connect the usual way.
+        const int one = 1;
+        setsockopt(handle, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, (const char *) &one, sizeof (one));
+    }
+    #endif
+
+    return true;
+}
+
+// make a non-blocking socket with the app's options and start it connecting. Returns INVALID_SOCKET and sets the error on failure.
+static Socket StartStreamConnection(const struct sockaddr *saddr, SockLen saddrlen, const NET_StreamSocketOptions *opts)
+{
+    const Socket handle = socket(saddr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+    if (handle == INVALID_SOCKET) {
         SetLastSocketError("Failed to create socket");
-        freeaddrinfo(addrwithport);
-        SDL_free(sock);
-        return NULL;
+        return INVALID_SOCKET;
     }
 
-    if (MakeSocketNonblocking(sock->handle) < 0) {
-        CloseSocketHandle(sock->handle);
-        freeaddrinfo(addrwithport);
-        SDL_free(sock);
+    if (MakeSocketNonblocking(handle) < 0) {
+        CloseSocketHandle(handle);
         SDL_SetError("Failed to make new socket non-blocking");
-        return NULL;
+        return INVALID_SOCKET;
     }
 
-    const int rc = connect(sock->handle, addrwithport->ai_addr, (SockLen) addrwithport->ai_addrlen);
-
-    freeaddrinfo(addrwithport);
+    // set these before connecting, so things like the receive window are negotiated with them in place.
+    if (!ApplyStreamSocketOptions(handle, saddr->sa_family, opts)) {
+        CloseSocketHandle(handle);
+        return INVALID_SOCKET;  // error string was already set.
+    }
 
-    if (rc == SOCKET_ERROR) {
+    if (connect(handle, saddr, saddrlen) == SOCKET_ERROR) {
         const int err = LastSocketError();
         if (!WouldBlock(err)) {
             SetSocketError("Connection failed at startup", err);
-            CloseSocketHandle(sock->handle);
-            SDL_free(sock);
-            return NULL;
+            CloseSocketHandle(handle);
+            return INVALID_SOCKET;
         }
     }
 
-    NET_RefAddress(addr);
-    return sock;
+    return handle;
 }
 
-static NET_Status CheckClientConnection(NET_StreamSocket *sock, int timeoutms)
+// RFC 8305 recommends waiting 250 milliseconds for a connection attempt before starting the next one.
+#define DEFAULT_CONNECT_RACE_DELAY 250
+
+// connections being raced to every address a hostname resolved to (RFC 8305, "Happy Eyeballs").
+typedef struct NET_ConnectRace
 {
-    if (!sock) {
-        return SDL_InvalidParamError("sock");
-    } else if (sock->status == NET_WAITING) {  // still pending?
-        /*!!! FIXME: add this later?
-        if (sock->simulated_failure_ticks) {
-            if (SDL_GetTicks() >= sock->simulated_failure_ticks) {
-                sock->status = (NET_Status) SDL_SetError("simulated failure");
-        } else */
-        if (NET_WaitUntilInputAvailable((void **) &sock, 1, timeoutms) == NET_FAILURE) {
-            sock->status = NET_FAILURE;  // just abandon the whole enterprise.
+    NET_StreamSocketOptions options;
+    AddressStorage *candidates;  // every distinct address, with the port filled in, in the order we'll try them.
+    SockLen *candidate_lens;
+    int num_candidates;
+    int next_candidate;
+    Socket *attempts;  // connections still in flight; never more than num_candidates.
+    int num_attempts;
+    Uint32 delay;  // milliseconds to give an attempt before starting another one alongside it.
+    Uint64 next_attempt_ticks;
+    char *errstr;  // why the most recent attempt failed, to report if they all do.
+} NET_ConnectRace;
+
+static void FreeConnectRace(NET_ConnectRace *race)
+{
+    if (race) {
+        for (int i = 0; i < race->num_attempts; i++) {
+            CloseSocketHandle(race->attempts[i]);
         }
+        SDL_free(race->candidates);
+        SDL_free(race->candidate_lens);
+        SDL_free(race->attempts);
+        SDL_free(race->errstr);
+        SDL_free(race);
     }
-    return sock->status;
 }
 
-NET_Status NET_WaitUntilConnected(NET_StreamSocket *sock, Sint32 timeout)
+// gather every distinct IPv4 and IPv6 address `addr` resolved to, alternating families starting with IPv6, as
+//  RFC 8305 suggests. Sets *race to NULL if there's only one address, so there's nothing to race.
+static bool CreateConnectRace(const NET_Address *addr, Uint16 port, const NET_StreamSocketOptions *opts, Uint32 delay, NET_ConnectRace **race)
 {
-    return CheckClientConnection(sock, (int) timeout);
-}
+    *race = NULL;
+
+    int total = 0;
+    for (const struct addrinfo *i = addr->ainfo; i != NULL; i = i->ai_next) {
+        total++;
+    }
+
+    AddressStorage *candidates = (AddressStorage *) SDL_calloc(total, sizeof (AddressStorage));
+    SockLen *candidate_lens = (SockLen *) SDL_calloc(total, sizeof (SockLen));
+    Socket *attempts = (Socket *) SDL_calloc(total, sizeof (Socket));
+    NET_ConnectRace *retval = (NET_ConnectRace *) SDL_calloc(1, sizeof (NET_ConnectRace));
+    if (!candidates || !candidate_lens || !attempts || !retval) {
+        SDL_free(candidates);
+        SDL_free(candidate_lens);
+        SDL_free(attempts);
+        SDL_free(retval);
+        return false;
+    }
 
-NET_Status NET_GetConnectionStatus(NET_StreamSocket *sock)
-{
-    return CheckClientConnection(sock, 0);
-}
+    retval->candidates = candidates;
+    retval->candidate_lens = candidate_lens;
+    retval->attempts = attempts;
+    retval->options = *opts;
+    retval->delay = delay;
 
+    // take turns between IPv6 and IPv4, skipping duplicates; getaddrinfo lists each address once per socket type.
+    static const int families[2] = { AF_INET6, AF_INET };
+    const struct addrinfo *next[2] = { addr->ainfo, addr->ainfo };
+    for (int turn = 0; next[0] || next[1]; turn ^= 1) {
+        for (const struct addrinfo *ainfo = next[turn]; ainfo != NULL; ainfo = ainfo->ai_next) {
+            next[turn] = ainfo->ai_next;
+            if ((ainfo->ai_family != families[turn]) || (ainfo->ai_addrlen > sizeof (AddressStorage))) {
+                continue;
+            }
 
-struct NET_Server
-{
-    NET_SocketType socktype;
-    NET_Address *addr;  // bound to this address (NULL for any).
-    Uint16 port;
-    int num_handles;   // for INADDR_ANY things, one handle per network family.
-    Socket *handles;
-    Socket handle_pool[4];
-};
+            bool duplicate = false;
+            for (int i = 0; i < retval->num_candidates; i++) {
+                if ((candidate_lens[i] == (SockLen) ainfo->ai_addrlen) && (SDL_memcmp(&candidates[i], ainfo->ai_addr, ainfo->ai_addrlen) == 0)) {
+                    duplicate = true;
+                    break;
+                }
+            }
 
-NET_Server *NET_CreateServer(NET_Address *addr, Uint16 port, SDL_PropertiesID props)
-{
-    if (addr && (((NET_Status) SDL_GetAtomicInt(&addr->status)) != NET_SUCCESS)) {
-        SDL_SetError("Address is not resolved");  // strictly speaking, this should be a local interface, but a resolved address can fail later.
-        return NULL;
+            if (!duplicate) {
+                SDL_memcpy(&candidates[retval->num_candidates], ainfo->ai_addr, ainfo->ai_addrlen);
+                candidate_lens[retval->num_candidates] = (SockLen) ainfo->ai_addrlen;
+                retval->num_candidates++;
+                break;  // the other family's turn.
+            }
+        }
     }
 
-    struct addrinfo *addrwithport = MakeAddrInfoWithPort(addr, SOCK_STREAM, port);
-    if (!addrwithport) {
-        return NULL;
+    if (retval->num_candidates < 2) {
+        FreeConnectRace(retval);
+        return true;  // nothing to race; just connect the usual way.
     }
 
-    NET_Server *server = (NET_Server *) SDL_calloc(1, sizeof (NET_Server));
-    if (!server) {
-        freeaddrinfo(addrwithport);
-        return NULL;
+    // dedupe before filling in the port, since getaddrinfo left it zero in all of them.
+    for (int i = 0; i < retval->num_candidates; i++) {
+        if (candidates[i].ss_family == AF_INET6) {
+            ((struct sockaddr_in6 *) &candidates[i])->sin6_port = htons(port);
+        } else {
+            ((struct sockaddr_in *) &candidates[i])->sin_port = htons(port);
+        }
+    }
+
+    *race = retval;
+    return true;
+}
+
+static void RecordConnectRaceFailure(NET_ConnectRace *race)
+{
+    SDL_free(race->errstr);
+    race->errstr = SDL_strdup(SDL_GetError());
+}
+
+// start the next connection attempt if the current ones have had long enough, or right away if none are in flight.
+static void StartConnectAttempts(NET_ConnectRace *race, Uint64 now)
+{
+    while ((race->next_candidate < race->num_candidates) && ((race->num_attempts == 0) || (now >= race->next_attempt_ticks))) {
+        const int i = race->next_candidate++;
+        const Socket handle = StartStreamConnection((const struct sockaddr *) &race->candidates[i], race->candidate_lens[i], &race->options);
+        if (handle == INVALID_SOCKET) {
+            RecordConnectRaceFailure(race);  // move on to the next one.
+        } else {
+            race->attempts[race->num_attempts++] = handle;
+            race->next_attempt_ticks = now + race->delay;
+        }
+    }
+}
+
+// handle poll() results for a race's attempts (`pfds` has one entry per candidate, the first num_attempts of them in
+//  use), and start more attempts if it's time. Returns true if the race is over, won or lost.
+static bool UpdateConnectRace(NET_StreamSocket *sock, const struct pollfd *pfds, Uint64 now)
+{
+    NET_ConnectRace *race = sock->race;
+    SDL_assert(race != NULL);
+
+    Socket winner = INVALID_SOCKET;
+    for (int i = race->num_attempts - 1; i >= 0; i--) {  // backwards, so removing an attempt doesn't disturb the ones left to check.
+        SDL_assert(pfds[i].fd == race->attempts[i]);
+        const bool failed = ((pfds[i].revents & (POLLERR|POLLHUP|POLLNVAL)) != 0) ? true : false;
+        const bool writable = (pfds[i].revents & POLLOUT) ? true : false;
+        if (!failed && !writable) {
+            continue;  // still connecting.
+        }
+
+        const Socket handle = race->attempts[i];
+        race->attempts[i] = race->attempts[--race->num_attempts];
+
+        if (!failed) {
+            winner = handle;
+            break;
+        }
+
+        int err = 0;
+        SockLen errsize = sizeof (err);
+        getsockopt(handle, SOL_SOCKET, SO_ERROR, (char*)&err, &errsize);
+        SetSocketError("Socket failed to connect", err);
+        RecordConnectRaceFailure(race);
+        CloseSocketHandle(handle);
+        race->next_attempt_ticks = now;  // don't wait around, start the next one now.
+    }
+
+    if (winner != INVALID_SOCKET) {
+        sock->handle = winner;
+        sock->status = NET_SUCCESS;
+    } else {
+        StartConnectAttempts(race, now);
+        if (race->num_attempts > 0) {
+            return false;  // still going.
+        }
+        SDL_SetError("%s", race->errstr ? race->errstr : "Failed to connect");
+        sock->status = NET_FAILURE;
+    }
+
+    FreeConnectRace(race);  // this closes the losers.
+    sock->race = NULL;
+    return true;
+}
+
+// racing connection attempts leaves a stream socket without a handle until one wins. Returns 1 if there's a handle to
+//  use, 0 if still connecting, -1 (with the error set) if every attempt failed.
+static int CheckStreamSocketHandle(NET_StreamSocket *sock)
+{
+    if (sock->handle != INVALID_SOCKET) {
+        return 1;
+    } else if (sock->status == NET_WAITING) {
+        return 0;
+    }
+    SDL_SetError("Socket failed to connect");
+    return -1;
+}
+
+NET_StreamSocket *NET_CreateClient(NET_Address *addr, Uint16 port, SDL_PropertiesID props)
+{
+    if (addr == NULL) {
+        SDL_InvalidParamError("address");
+        return NULL;
+    } else if (((NET_Status) SDL_GetAtomicInt(&addr->status)) != NET_SUCCESS) {
+        SDL_SetError("Address is not resolved");
+        return NULL;
+    }
+
+    NET_StreamSocket *sock = (NET_StreamSocket *) SDL_calloc(1, sizeof (NET_StreamSocket));
+    if (!sock) {
+        return NULL;
+    }
+
+    sock->socktype = SOCKETTYPE_STREAM;
+    sock->addr = addr;
+    sock->port = port;
+    sock->handle = INVALID_SOCKET;
+
+    NET_StreamSocketOptions opts;
+    GetStreamSocketOptions(props, &opts);
+
+    if (SDL_GetBooleanProperty(props, NET_PROP_CLIENT_HAPPY_EYEBALLS_BOOLEAN, false)) {
+        // no Fast Open here: a deferred connect() looks connected right away, so the first attempt would always "win."
+        const Sint64 delay = SDL_GetNumberProperty(props, NET_PROP_CLIENT_HAPPY_EYEBALLS_DELAY_NUMBER, DEFAULT_CONNECT_RACE_DELAY);
+        if (!CreateConnectRace(addr, port, &opts, (Uint32) SDL_clamp(delay, 0, SDL_MAX_SINT32), &sock->race)) {
+            SDL_free(sock);
+            return NULL;
+        }
+    }
+
+    if (sock->race) {
+        StartConnectAttempts(sock->race, SDL_GetTicks());
+        if (sock->race->num_attempts == 0) {  // couldn't even start connecting to any of them?
+            SDL_SetError("%s", sock->race->errstr ? sock->race->errstr : "Failed to connect");
+            FreeConnectRace(sock->race);
+            SDL_free(sock);
+            return NULL;
+        }
+        NET_RefAddress(addr);
+        return sock;
+    }
+
+    opts.fastopen_connect = SDL_GetBooleanProperty(props, NET_PROP_CLIENT_FASTOPEN_BOOLEAN, false) ? 1 : -1;
+
+    // we need to set up a sockaddr with the port in it for connect(), which is kind of a pain, since we
+    // want to keep things generic and also not set up a port at resolve time.
+    struct addrinfo *addrwithport = MakeAddrInfoWithPort(addr, SOCK_STREAM, port);
+    if (!addrwithport) {
+        SDL_free(sock);
+        return NULL;
+    }
+
+    sock->handle = StartStreamConnection(addrwithport->ai_addr, (SockLen) addrwithport->ai_addrlen, &opts);
+
+    freeaddrinfo(addrwithport);
+
+    if (sock->handle == INVALID_SOCKET) {
+        SDL_free(sock);
+        return NULL;  // error string was already set.
+    }
+
+    NET_RefAddress(addr);
+    return sock;
+}
+
+static NET_Status CheckClientConnection(NET_StreamSocket *sock, int timeoutms)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if (sock->status == NET_WAITING) {  // still pending?
+        /*!!! FIXME: add this later?
+        if (sock->simulated_failure_ticks) {
+            if (SDL_GetTicks() >= sock->simulated_failure_ticks) {
+                sock->status = (NET_Status) SDL_SetError("simulated failure");
+        } else */
+        if (NET_WaitUntilInputAvailable((void **) &sock, 1, timeoutms) == NET_FAILURE) {
+            sock->status = NET_FAILURE;  // just abandon the whole enterprise.
+        }
+    }
+    return sock->status;
+}
+
+NET_Status NET_WaitUntilConnected(NET_StreamSocket *sock, Sint32 timeout)
+{
+    return CheckClientConnection(sock, (int) timeout);
+}
+
+NET_Status NET_GetConnectionStatus(NET_StreamSocket *sock)
+{
+    return CheckClientConnection(sock, 0);
+}
+
+
+struct NET_Server
+{
+    NET_SocketType socktype;
+    NET_Address *addr;  // bound to this address (NULL for any).
+    Uint16 port;
+    int num_handles;   // for INADDR_ANY things, one handle per network family.
+    Socket *handles;
+    Socket handle_pool[4];
+    bool input_needs_drain;  // reported by NET_WaitUntilNewInputAvailable, but not accepted until it would block yet.
+    NET_StreamSocketOptions client_options;  // applied to every accepted stream socket.
+};
+
+NET_Server *NET_CreateServer(NET_Address *addr, Uint16 port, SDL_PropertiesID props)
+{
+    if (addr && (((NET_Status) SDL_GetAtomicInt(&addr->status)) != NET_SUCCESS)) {
+        SDL_SetError("Address is not resolved");  // strictly speaking, this should be a local interface, but a resolved address can fail later.
+        return NULL;
+    }
+
+    struct addrinfo *addrwithport = MakeAddrInfoWithPort(addr, SOCK_STREAM, port);
+    if (!addrwithport) {
+        return NULL;
+    }
+
+    NET_Server *server = (NET_Server *) SDL_calloc(1, sizeof (NET_Server));
+    if (!server) {
+        freeaddrinfo(addrwithport);
+        return NULL;
     }
 
     server->socktype = SOCKETTYPE_SERVER;
@@ -1743,6 +2429,11 @@ NET_Server *NET_CreateServer(NET_Address *addr, Uint16 port, SDL_PropertiesID pr
     }
 
     const int reuseaddr = SDL_GetBooleanProperty(props, NET_PROP_SERVER_REUSEADDR_BOOLEAN, true) ? 1 : 0;
+    const bool reuseport = SDL_GetBooleanProperty(props, NET_PROP_SERVER_REUSEPORT_BOOLEAN, false);
+    const Sint64 backlog_prop = SDL_GetNumberProperty(props, NET_PROP_SERVER_BACKLOG_NUMBER, 0);
+    const int backlog = (backlog_prop > 0) ? (int) SDL_min(backlog_prop, SDL_MAX_SINT32) : SOMAXCONN;
+    const int fastopen_queue = (int) SDL_clamp(SDL_GetNumberProperty(props, NET_PROP_SERVER_FASTOPEN_QUEUE_NUMBER, 0), 0, SDL_MAX_SINT32);
+    GetStreamSocketOptions(props, &server->client_options);
 
     // Make sockets for all desired interfaces; if addr!=NULL, this is one socket on one interface,
     //  but if addr==NULL, it might be multiple sockets for IPv4, IPv6, etc, bound to their INADDR_ANY equivalent.
@@ -1769,6 +2460,23 @@ NET_Server *NET_CreateServer(NET_Address *addr, Uint16 port, SDL_PropertiesID pr
 
         setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, (const char *) &reuseaddr, sizeof (reuseaddr));
 
+        if (reuseport && !EnableReusePort(handle)) {
+            goto failed;  // error string was already set.
+        }
+
+        // most systems pass these on to accepted sockets, and buffer sizes have to be set before listen() to affect
+        //  the receive window, but we set them again on each accepted socket for the ones that don't. This also
+        //  makes sure any bad values fail here instead of later.
+        if (!ApplyStreamSocketOptions(handle, ainfo->ai_family, &server->client_options)) {
+            goto failed;  // error string was already set.
+        }
+
+        #ifdef TCP_FASTOPEN
+        if (fastopen_queue > 0) {
+            setsockopt(handle, IPPROTO_TCP, TCP_FASTOPEN, (const char *) &fastopen_queue, sizeof (fastopen_queue));  // if this fails, oh well, clients just do a normal handshake.
+        }
+        #endif
+
         int rc = bind(handle, ainfo->ai_addr, (SockLen) ainfo->ai_addrlen);
         if (rc == SOCKET_ERROR) {
             const int err = LastSocketError();
@@ -1777,7 +2485,7 @@ NET_Server *NET_CreateServer(NET_Address *addr, Uint16 port, SDL_PropertiesID pr
             goto failed;
         }
 
-        rc = listen(handle, 16);
+        rc = listen(handle, backlog);
         if (rc == SOCKET_ERROR) {
             const int err = LastSocketError();
             SDL_assert(!WouldBlock(err));  // listen shouldn't be a blocking operation.
@@ -1801,6 +2509,69 @@ failed:
     return NULL;
 }
 
+// accept one pending connection on a listen socket. Returns 1 if we got one, 0 if none are waiting, -1 on error.
+static int AcceptClientOnHandle(NET_Server *server, Socket listen_handle, NET_StreamSocket **client_stream)
+{
+    AddressStorage from;
+    SockLen fromlen = sizeof (from);
+    #ifdef USE_ACCEPT4
+    const Socket handle = accept4(listen_handle, (struct sockaddr *) &from, &fromlen, SOCK_NONBLOCK | SOCK_CLOEXEC);  // one syscall instead of three.
+    #else
+    const Socket handle = accept(listen_handle, (struct sockaddr *) &from, &fromlen);
+    #endif
+    if (handle == INVALID_SOCKET) {
+        const int err = LastSocketError();
+        return WouldBlock(err) ? 0 : SetSocketError("Failed to accept new connection", err);
+    }
+
+    #ifndef USE_ACCEPT4
+    if (MakeSocketNonblocking(handle) < 0) {
+        CloseSocketHandle(handle);
+        SDL_SetError("Failed to make incoming socket non-blocking");
+        return -1;
+    }
+    #endif
+
+    ApplyStreamSocketOptions(handle, from.ss_family, &server->client_options);  // these worked on the listen socket, so if this fails, oh well.
+
+    Uint16 port;
+    if (from.ss_family == AF_INET) {
+        port = ntohs(((const struct sockaddr_in *) &from)->sin_port);
+    } else if (from.ss_family == AF_INET6) {
+        port = ntohs(((const struct sockaddr_in6 *) &from)->sin6_port);
+    } else {
+        char portbuf[16];
+        const int gairc = getnameinfo((struct sockaddr *) &from, fromlen, NULL, 0, portbuf, sizeof (portbuf), NI_NUMERICSERV);
+        if (gairc != 0) {
+            CloseSocketHandle(handle);
+            return SetGetAddrInfoError("Failed to determine port number", gairc);
+        }
+        port = (Uint16) SDL_atoi(portbuf);
+    }
+
+    NET_Address *fromaddr = CreateSDLNetAddrFromSockAddr((struct sockaddr *) &from, fromlen);
+    if (!fromaddr) {
+        CloseSocketHandle(handle);
+        return -1;  // error string was already set.
+    }
+
+    NET_StreamSocket *sock = (NET_StreamSocket *) SDL_calloc(1, sizeof (NET_StreamSocket));
+    if (!sock) {
+        NET_UnrefAddress(fromaddr);
+        CloseSocketHandle(handle);
+        return -1;
+    }
+
+    sock->socktype = SOCKETTYPE_STREAM;
+    sock->addr = fromaddr;
+    sock->port = port;
+    sock->handle = handle;
+    sock->status = NET_SUCCESS;  // connected
+
+    *client_stream = sock;
+    return 1;  // we got one!
+}
+
 bool NET_AcceptClient(NET_Server *server, NET_StreamSocket **client_stream)
 {
     if (!client_stream) {
@@ -1814,53 +2585,54 @@ bool NET_AcceptClient(NET_Server *server, NET_StreamSocket **client_stream)
     }
 
     for (int i = 0; i < server->num_handles; i++) {
-        AddressStorage from;
-        SockLen fromlen = sizeof (from);
-        const Socket handle = accept(server->handles[i], (struct sockaddr *) &from, &fromlen);
-        if (handle == INVALID_SOCKET) {
-            const int err = LastSocketError();
-            if (WouldBlock(err)) {
-                continue;
-            }
-            return SetSocketErrorBool("Failed to accept new connection", err);
-        }
-
-        if (MakeSocketNonblocking(handle) < 0) {
-            CloseSocketHandle(handle);
-            return SDL_SetError("Failed to make incoming socket non-blocking");
+        const int rc = AcceptClientOnHandle(server, server->handles[i], client_stream);
+        if (rc < 0) {
+            return false;
+        } else if (rc > 0) {
+            return true;  // we got one!
         }
+    }
 
-        char portbuf[16];
-        const int gairc = getnameinfo((struct sockaddr *) &from, fromlen, NULL, 0, portbuf, sizeof (portbuf), NI_NUMERICSERV);
-        if (gairc != 0) {
-            CloseSocketHandle(handle);
-            return SetGetAddrInfoErrorBool("Failed to determine port number", gairc);
-        }
+    server->input_needs_drain = false;  // everything would block, so we've drained the listen queue.
+    return true;  // nothing new.
+}
 
-        NET_Address *fromaddr = CreateSDLNetAddrFromSockAddr((struct sockaddr *) &from, fromlen);
-        if (!fromaddr) {
-            CloseSocketHandle(handle);
-            return false;  // error string was already set.
-        }
+int NET_AcceptClients(NET_Server *server, NET_StreamSocket **clients, int max)
+{
+    if (!server) {
+        SDL_InvalidParamError("server");
+        return -1;
+    } else if (!clients) {
+        SDL_InvalidParamError("clients");
+        return -1;
+    } else if (max < 0) {
+        SDL_InvalidParamError("max");
+        return -1;
+    }
 
-        NET_StreamSocket *sock = (NET_StreamSocket *) SDL_calloc(1, sizeof (NET_StreamSocket));
-        if (!sock) {
-            NET_UnrefAddress(fromaddr);
-            CloseSocketHandle(handle);
-            return false;
+    // take turns between the listen sockets, so one busy address family doesn't starve the others, until they're
+    //  all drained or the caller's array is full.
+    int count = 0;
+    int drained = 0;
+    while ((count < max) && (drained < server->num_handles)) {
+        drained = 0;
+        for (int i = 0; (i < server->num_handles) && (count < max); i++) {
+            const int rc = AcceptClientOnHandle(server, server->handles[i], &clients[count]);
+            if (rc < 0) {
+                return (count > 0) ? count : -1;  // report what we got; whatever failed will probably fail again next time.
+            } else if (rc > 0) {
+                count++;
+            } else {
+                drained++;
+            }
         }
+    }
 
-        sock->socktype = SOCKETTYPE_STREAM;
-        sock->addr = fromaddr;
-        sock->port = (Uint16) SDL_atoi(portbuf);
-        sock->handle = handle;
-        sock->status = NET_SUCCESS;  // connected
-
-        *client_stream = sock;
-        return true;  // we got one!
+    if (drained == server->num_handles) {
+        server->input_needs_drain = false;  // everything would block, so we've drained the listen queue.
     }
 
-    return true;  // nothing new.
+    return count;
 }
 
 void NET_DestroyServer(NET_Server *server)
@@ -1898,157 +2670,1241 @@ static void UpdateStreamSocketSimulatedFailure(NET_StreamSocket *sock)
     }
 }
 
-// see if any pending data can finally be sent, etc
-static bool PumpStreamSocket(NET_StreamSocket *sock)
+// milliseconds until a stream socket is allowed to move data again (zero if it can right now).
+static Uint64 StreamSocketSimulatedLagRemaining(const NET_StreamSocket *sock, Uint64 now)
 {
-    if (!sock) {
-        return SDL_InvalidParamError("sock");
-    } else if (sock->pending_output_len > 0) {
-        // !!! FIXME: there should be some small chance of streams dropping connection to simulate failure.
-        if (sock->simulated_failure_until && (SDL_GetTicks() < sock->simulated_failure_until)) {
-            return true;  // streams are reliable, so instead of packet loss, we introduce lag.
-        }
+    return (sock->simulated_failure_until > now) ? (sock->simulated_failure_until - now) : 0;
+}
 
-        const int bw = (int) write(sock->handle, sock->pending_output_buffer, sock->pending_output_len);
-        if (bw < 0) {
-            const int err = LastSocketError();
-            return WouldBlock(err) ? true : SetSocketErrorBool("Failed to write to socket", err);
-        } else if (bw < sock->pending_output_len) {
-            SDL_memmove(sock->pending_output_buffer, sock->pending_output_buffer + bw, ((size_t) sock->pending_output_len) - bw);
-        }
-        sock->pending_output_len -= bw;
+// true if pending_output_buffer or pending_ranges have anything left to send. In thread-safe mode, must hold pump_lock!
+static bool StreamSocketHasPendingOutput(const NET_StreamSocket *sock)
+{
+    return (sock->pending_output_len > 0) || (sock->pending_ranges != NULL);
+}
 
-        UpdateStreamSocketSimulatedFailure(sock);
-    }
+// bytes left in pending_output_buffer and pending_ranges, capped to fit in an int. In thread-safe mode, must hold pump_lock!
+static int GetStreamSocketQueuedOutputLen(const NET_StreamSocket *sock)
+{
+    return (int) SDL_min(((Sint64) sock->pending_output_len) + sock->pending_range_bytes, (Sint64) SDL_MAX_SINT32);
+}
 
-    return true;
+// bytes we still have to send, including writes other threads have queued but nobody has pumped yet.
+static int GetStreamSocketPendingOutputLen(NET_StreamSocket *sock)
+{
+    if (sock->threadsafe_writes) {
+        const Sint64 total = ((Sint64) SDL_GetAtomicInt(&sock->published_pending_output_len)) + SDL_GetAtomicInt(&sock->write_queue_len);
+        return (int) SDL_min(total, (Sint64) SDL_MAX_SINT32);
+    }
+    return GetStreamSocketQueuedOutputLen(sock);
 }
 
-bool NET_WriteToStreamSocket(NET_StreamSocket *sock, const void *buf, int buflen)
+// true if there's pending output that we could send right now if the socket became writable.
+static bool StreamSocketWantsWrite(NET_StreamSocket *sock, Uint64 now)
 {
-    if (!PumpStreamSocket(sock)) {  // try to flush any queued data to the socket now, before we handle more.
-        return false;
-    } else if (buf == NULL) {
-        return SDL_InvalidParamError("buf");
-    } else if (buflen < 0) {
-        return SDL_InvalidParamError("buflen");
-    } else if (buflen == 0) {
-        return true;  // nothing to do.
+    if (sock->threadsafe_writes) {  // we don't simulate lag on writes in thread-safe mode.
+        return GetStreamSocketPendingOutputLen(sock) > 0;
     }
+    return StreamSocketHasPendingOutput(sock) && (StreamSocketSimulatedLagRemaining(sock, now) == 0);
+}
 
-    if (sock->pending_output_len == 0) {  // nothing queued? See if we can just send this without queueing.
-        // don't ever try to send directly if simulating packet loss; we'll always queue and mess with it then.
-        if (sock->percent_loss == 0) {
-            const int bw = (int) write(sock->handle, buf, buflen);
-            if (bw < 0) {
-                const int err = LastSocketError();
+// make sure pending_output_buffer can hold `buflen` more bytes.
+static bool GrowStreamSocketOutput(NET_StreamSocket *sock, int buflen)
+{
+    const int min_alloc = sock->pending_output_len + buflen;
+    if (min_alloc < 0) {  // uhoh, overflowed! That's a lot of memory!!
+        return SDL_OutOfMemory();
+    } else if (min_alloc > sock->pending_output_allocation) {
+        int newlen = SDL_max(1, sock->pending_output_allocation);
+        while (newlen < min_alloc) {
+            newlen *= 2;
+            if (newlen < 0) {  // uhoh, overflowed! That's a lot of memory!!
+                return SDL_OutOfMemory();
+            }
+        }
+        void *ptr = SDL_realloc(sock->pending_output_buffer, newlen);
+        if (!ptr) {
+            return false;
+        }
+        sock->pending_output_buffer = (Uint8 *) ptr;
+        sock->pending_output_allocation = newlen;
+    }
+    return true;
+}
+
+// add everything in `iov` after the first `skip` bytes to the end of pending_output_buffer, to be sent when the socket is writable.
+static bool QueueStreamSocketOutputV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt, int skip, int buflen)
+{
+    if (!GrowStreamSocketOutput(sock, buflen)) {
+        return false;
+    }
+
+    for (int i = 0; i < iovcnt; i++) {
+        if (skip >= iov[i].buflen) {
+            skip -= iov[i].buflen;  // this one was already sent.
+        } else {
+            const int len = iov[i].buflen - skip;
+            SDL_memcpy(sock->pending_output_buffer + sock->pending_output_len, ((const Uint8 *) iov[i].buf) + skip, len);
+            sock->pending_output_len += len;
+            skip = 0;
+        }
+    }
+
+    return true;
+}
+
+// add data to the end of pending_output_buffer, to be sent when the socket is writable.
+static bool QueueStreamSocketOutput(NET_StreamSocket *sock, const void *buf, int buflen)
+{
+    NET_IOVec iov;
+    iov.buf = (void *) buf;
+    iov.buflen = buflen;
+    return QueueStreamSocketOutputV(sock, &iov, 1, 0, buflen);
+}
+
+static void FreePendingRange(NET_PendingRange *range)
+{
+    if (range->closeio) {
+        SDL_CloseIO(range->io);
+    }
+    SDL_free(range);
+}
+
+// send some of a pending zero-copy buffer. Returns bytes sent (zero if the socket is full), -1 on failure.
+static Sint64 SendStreamSocketZeroCopyRange(NET_StreamSocket *sock, NET_PendingRange *range)
+{
+    const void *ptr = range->buf + range->offset;
+    const int len = (int) SDL_min(range->remaining, (Sint64) SDL_MAX_SINT32);
+
+    #ifdef USE_ZEROCOPY
+    if (sock->zerocopy_state > 0) {
+        const int bw = (int) send(sock->handle, ptr, len, MSG_ZEROCOPY);
+        if (bw >= 0) {
+            range->zerocopy->pinned = true;
+            range->zerocopy->last_send = sock->zerocopy_sends++;
+            return (Sint64) bw;
+        }
+
+        const int err = errno;
+        if (WouldBlock(err)) {
+            return 0;
+        } else if (err != ENOBUFS) {  // ENOBUFS means we hit a limit on pinned memory; just copy this piece like a normal write.
+            return SetSocketError("Failed to write to socket", err);
+        }
+    }
+    #endif
+
+    const int bw = (int) write(sock->handle, ptr, len);
+    if (bw < 0) {
+        const int err = LastSocketError();
+        return WouldBlock(err) ? 0 : SetSocketError("Failed to write to socket", err);
+    }
+    return (Sint64) bw;
+}
+
+// send some of a pending range. Returns bytes sent (zero if the socket is full), -1 on failure.
+static Sint64 SendStreamSocketRange(NET_StreamSocket *sock, NET_PendingRange *range)
+{
+    if (range->zerocopy) {
+        return SendStreamSocketZeroCopyRange(sock, range);
+    }
+
+    #ifdef USE_SENDFILE
+    if (range->fd >= 0) {  // the kernel can move this straight from the file to the socket.
+        off_t offset = (off_t) range->offset;
+        const size_t count = (size_t) SDL_min(range->remaining, (Sint64) 0x7FFFF000);  // Linux won't move more than this per call anyhow.
+        const ssize_t rc = sendfile(sock->handle, range->fd, &offset, count);
+        if (rc > 0) {
+            return (Sint64) rc;
+        } else if (rc == 0) {
+            SDL_SetError("Unexpected end of file");
+            return -1;
+        }
+
+        const int err = errno;
+        if (WouldBlock(err)) {
+            return 0;
+        } else if ((err != EINVAL) && (err != ENOSYS)) {
+            return SetSocketError("Failed to write to socket", err);
+        }
+        range->fd = -1;  // this file can't be used with sendfile(), so read it through the SDL_IOStream from now on.
+    }
+    #endif
+
+    // no shortcut available, so read a chunk into memory and send as much of it as the socket will take.
+    Uint8 chunk[8 * 1024];
+    if (SDL_SeekIO(range->io, range->offset, SDL_IO_SEEK_SET) < 0) {
+        return -1;
+    }
+
+    const size_t br = SDL_ReadIO(range->io, chunk, (size_t) SDL_min(range->remaining, (Sint64) sizeof (chunk)));
+    if (br == 0) {
+        if (SDL_GetIOStatus(range->io) == SDL_IO_STATUS_EOF) {
+            SDL_SetError("Unexpected end of file");
+        }
+        return -1;
+    }
+
+    const int bw = (int) write(sock->handle, chunk, br);
+    if (bw < 0) {
+        const int err = LastSocketError();
+        return WouldBlock(err) ? 0 : SetSocketError("Failed to write to socket", err);
+    }
+    return (Sint64) bw;
+}
+
+// most bytes of pending ranges we'll send in one pump. A file read through an SDL_IOStream can keep a fast socket
+//  busy for a long time, and we don't want one socket to hold up a wait loop (or a writer) while it goes.
+#define STREAM_RANGE_PUMP_BUDGET (1024 * 1024)
+
+// send as much of pending_output_buffer and pending_ranges, in order, as the socket will take right now, up to
+//  STREAM_RANGE_PUMP_BUDGET bytes of ranges. Anything left waits for the next pump.
+static bool WriteStreamSocketPendingOutput(NET_StreamSocket *sock)
+{
+    Sint64 budget = STREAM_RANGE_PUMP_BUDGET;
+    while (true) {
+        NET_PendingRange *range = sock->pending_ranges;
+        const int buflen = range ? range->buffer_pos : sock->pending_output_len;  // memory that goes out before the next file range.
+
+        if (buflen > 0) {
+            const int bw = (int) write(sock->handle, sock->pending_output_buffer, buflen);
+            if (bw < 0) {
+                const int err = LastSocketError();
+                return WouldBlock(err) ? true : SetSocketErrorBool("Failed to write to socket", err);
+            } else if (bw < sock->pending_output_len) {
+                SDL_memmove(sock->pending_output_buffer, sock->pending_output_buffer + bw, ((size_t) sock->pending_output_len) - bw);
+            }
+            sock->pending_output_len -= bw;
+            for (NET_PendingRange *i = range; i != NULL; i = i->next) {
+                i->buffer_pos -= bw;
+            }
+
+            if (bw < buflen) {
+                return true;  // socket is full, try again later.
+            }
+        }
+
+        if (!range) {
+            return true;  // everything has been sent.
+        }
+
+        while (range->remaining > 0) {
+            if (budget <= 0) {
+                return true;  // sent enough for one pass; the socket is probably still writable, so we'll be back soon.
+            }
+            const Sint64 sent = SendStreamSocketRange(sock, range);
+            if (sent < 0) {
+                return false;
+            } else if (sent == 0) {
+                return true;  // socket is full, try again later.
+            }
+            range->offset += sent;
+            range->remaining -= sent;
+            sock->pending_range_bytes -= sent;
+            budget -= sent;
+        }
+
+        sock->pending_ranges = range->next;
+        if (!sock->pending_ranges) {
+            sock->pending_ranges_tail = NULL;
+        }
+        if (range->zerocopy) {
+            range->zerocopy->issued = true;
+        }
+        FreePendingRange(range);
+    }
+}
+
+// move everything other threads have pushed onto write_queue into pending_output_buffer. Must hold pump_lock!
+static bool CollectStreamSocketWriteQueue(NET_StreamSocket *sock)
+{
+    // the queue is a stack (newest first), so reverse it to get the writes back in the order they were made.
+    NET_StreamWriteNode *node = (NET_StreamWriteNode *) SDL_SetAtomicPointer(&sock->write_queue, NULL);
+    NET_StreamWriteNode *ordered = NULL;
+    while (node) {
+        NET_StreamWriteNode *next = node->next;
+        node->next = ordered;
+        ordered = node;
+        node = next;
+    }
+
+    bool retval = true;
+    while (ordered) {
+        NET_StreamWriteNode *next = ordered->next;
+        if (retval && !QueueStreamSocketOutput(sock, ordered + 1, ordered->len)) {
+            retval = false;  // out of memory. We can't keep the stream in order now, so drop the rest and report failure.
+        }
+        SDL_AddAtomicInt(&sock->write_queue_len, -ordered->len);
+        SDL_free(ordered);
+        ordered = next;
+    }
+    return retval;
+}
+
+// In thread-safe mode, a thread can be blocked in poll() on a socket that had nothing to send when it started
+//  waiting, so it isn't watching for writability. If another thread then queues output that the socket can't take
+//  yet, nothing would send it until the waiting thread woke up for some other reason, so writers poke this to wake
+//  it. It's a datagram socket on the loopback interface that is connected to itself, so a byte sent to it makes it
+//  readable; unlike a pipe, poll() can wait on it everywhere we have sockets.
+static Socket CreateWakeSocket(void)
+{
+    struct sockaddr_in addr;
+    SDL_zero(addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    SockLen addrlen = (SockLen) sizeof (addr);
+
+    const Socket handle = socket(AF_INET, SOCK_DGRAM, 0);
+    if (handle == INVALID_SOCKET) {
+        SetLastSocketError("Failed to create wakeup socket");
+        return INVALID_SOCKET;
+    } else if ((bind(handle, (struct sockaddr *) &addr, addrlen) == SOCKET_ERROR) ||
+               (getsockname(handle, (struct sockaddr *) &addr, &addrlen) == SOCKET_ERROR) ||
+               (connect(handle, (struct sockaddr *) &addr, addrlen) == SOCKET_ERROR) ||
+               (MakeSocketNonblocking(handle) < 0)) {
+        SetLastSocketError("Failed to set up wakeup socket");
+        CloseSocketHandle(handle);
+        return INVALID_SOCKET;
+    }
+
+    return handle;
+}
+
+// if a thread is blocked in poll() on this socket without watching for writability, wake it up so it starts to.
+static void WakeStreamSocketWaiter(NET_StreamSocket *sock)
+{
+    if (SDL_CompareAndSwapAtomicInt(&sock->wake_needed, 1, 0)) {  // only the first writer to get here has to send anything.
+        const Uint8 byte = 0;
+        write(sock->wake_handle, &byte, 1);  // if this fails, oh well; it probably means there are already wakeups waiting to be read.
+    }
+}
+
+static void DrainWakeSocket(Socket handle)
+{
+    char buf[16];
+    while (read(handle, buf, sizeof (buf)) > 0) {
+        // just throw them away.
+    }
+}
+
+// Pump a socket in thread-safe mode. Whoever holds pump_lock is already sending, so we never wait on it; they
+//  check for new writes after they let go, so anything we queued will still get picked up.
+static bool PumpThreadSafeStreamSocket(NET_StreamSocket *sock)
+{
+    bool retval = true;
+    while (SDL_TryLockSpinlock(&sock->pump_lock)) {
+        if (!CollectStreamSocketWriteQueue(sock) || !WriteStreamSocketPendingOutput(sock)) {
+            retval = false;
+        }
+        SDL_SetAtomicInt(&sock->published_pending_output_len, GetStreamSocketQueuedOutputLen(sock));
+        SDL_UnlockSpinlock(&sock->pump_lock);
+
+        if (!retval || (SDL_GetAtomicPointer(&sock->write_queue) == NULL)) {
+            break;  // failed, or nothing new showed up while we held the lock.
+        }
+    }
+
+    if (retval && (GetStreamSocketPendingOutputLen(sock) > 0)) {
+        WakeStreamSocketWaiter(sock);  // the socket couldn't take it all; make sure a waiting thread sends the rest when it can.
+    }
+
+    return retval;
+}
+
+// see if any pending data can finally be sent, etc
+static bool PumpStreamSocket(NET_StreamSocket *sock)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if (sock->handle == INVALID_SOCKET) {
+        return (CheckStreamSocketHandle(sock) == 0);  // still racing connection attempts, so nothing can go out yet.
+    } else if (sock->threadsafe_writes) {
+        return PumpThreadSafeStreamSocket(sock);
+    } else if (StreamSocketHasPendingOutput(sock)) {
+        // !!! FIXME: there should be some small chance of streams dropping connection to simulate failure.
+        if (sock->simulated_failure_until && (SDL_GetTicks() < sock->simulated_failure_until)) {
+            return true;  // streams are reliable, so instead of packet loss, we introduce lag.
+        } else if (!WriteStreamSocketPendingOutput(sock)) {
+            return false;
+        }
+
+        UpdateStreamSocketSimulatedFailure(sock);
+    }
+
+    return true;
+}
+
+// writes and reads push pending output along as they go, unless the app corked the socket to batch things up.
+static bool PumpStreamSocketUnlessCorked(NET_StreamSocket *sock)
+{
+    return SDL_GetAtomicInt(&sock->corked) ? true : PumpStreamSocket(sock);
+}
+
+// any thread can call this; the data is copied onto the write queue and whoever manages to grab pump_lock sends it.
+static bool WriteToThreadSafeStreamSocket(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt, int buflen)
+{
+    NET_StreamWriteNode *node = (NET_StreamWriteNode *) SDL_malloc(sizeof (NET_StreamWriteNode) + buflen);
+    if (!node) {
+        return false;
+    }
+    node->len = buflen;
+    Uint8 *ptr = (Uint8 *) (node + 1);
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].buflen > 0) {
+            SDL_memcpy(ptr, iov[i].buf, iov[i].buflen);
+            ptr += iov[i].buflen;
+        }
+    }
+
+    SDL_AddAtomicInt(&sock->write_queue_len, buflen);  // count it before it's visible, so the collector never takes the total negative.
+    do {
+        node->next = (NET_StreamWriteNode *) SDL_GetAtomicPointer(&sock->write_queue);
+    } while (!SDL_CompareAndSwapAtomicPointer(&sock->write_queue, node->next, node));
+
+    return PumpStreamSocketUnlessCorked(sock);
+}
+
+// send (or queue) `buflen` total bytes from `iov`. Parameters have already been validated.
+static bool WriteToStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt, int buflen)
+{
+    if (buflen == 0) {
+        return PumpStreamSocketUnlessCorked(sock);  // nothing to add, but flush anything already queued.
+    } else if (sock->threadsafe_writes) {
+        return WriteToThreadSafeStreamSocket(sock, iov, iovcnt, buflen);
+    } else if (!PumpStreamSocketUnlessCorked(sock)) {  // try to flush any queued data to the socket now, before we handle more.
+        return false;
+    }
+
+    int skip = 0;
+    if (!StreamSocketHasPendingOutput(sock)) {  // nothing queued? See if we can just send this without queueing.
+        // don't ever try to send directly if simulating packet loss; we'll always queue and mess with it then.
+        //  If corked, always queue, so it goes out with whatever else gets written before the flush.
+        if ((sock->percent_loss == 0) && !SDL_GetAtomicInt(&sock->corked) && (sock->handle != INVALID_SOCKET)) {
+            const int bw = SocketWriteV(sock->handle, iov, iovcnt);
+            if (bw < 0) {
+                const int err = LastSocketError();
                 if (!WouldBlock(err)) {
                     return SetSocketErrorBool("Failed to write to socket", err);
                 }
-            } else if (bw == buflen) {  // sent the whole thing? We're good to go here.
-                return true;
-            } else /*if (bw < buflen)*/ {  // partial write? We'll queue the rest.
-                buf = ((const Uint8 *) buf) + bw;
-                buflen -= (int) bw;
+            } else if (bw == buflen) {  // sent the whole thing? We're good to go here.
+                return true;
+            } else /*if (bw < buflen)*/ {  // partial write? We'll queue the rest.
+                skip = bw;
+            }
+        }
+    }
+
+    // queue this up for sending later.
+    return QueueStreamSocketOutputV(sock, iov, iovcnt, skip, buflen - skip);
+}
+
+bool NET_WriteToStreamSocket(NET_StreamSocket *sock, const void *buf, int buflen)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if (buf == NULL) {
+        return SDL_InvalidParamError("buf");
+    } else if (buflen < 0) {
+        return SDL_InvalidParamError("buflen");
+    }
+
+    NET_IOVec iov;
+    iov.buf = (void *) buf;
+    iov.buflen = buflen;
+    return WriteToStreamSocketV(sock, &iov, 1, buflen);
+}
+
+bool NET_WriteToStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    }
+
+    const int buflen = GetIOVecTotalLength(iov, iovcnt);
+    if (buflen < 0) {
+        return false;
+    }
+
+    return WriteToStreamSocketV(sock, iov, iovcnt, buflen);
+}
+
+// in thread-safe mode, take pump_lock and get writes from other threads in line, so we can add to pending output.
+static bool LockStreamSocketOutput(NET_StreamSocket *sock)
+{
+    if (sock->threadsafe_writes) {
+        SDL_LockSpinlock(&sock->pump_lock);
+        if (!CollectStreamSocketWriteQueue(sock)) {
+            SDL_UnlockSpinlock(&sock->pump_lock);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void UnlockStreamSocketOutput(NET_StreamSocket *sock)
+{
+    if (sock->threadsafe_writes) {
+        SDL_SetAtomicInt(&sock->published_pending_output_len, GetStreamSocketQueuedOutputLen(sock));
+        SDL_UnlockSpinlock(&sock->pump_lock);
+    }
+}
+
+// queue up a range to send after everything already pending. Must hold LockStreamSocketOutput!
+static void AppendStreamSocketPendingRange(NET_StreamSocket *sock, NET_PendingRange *range)
+{
+    range->buffer_pos = sock->pending_output_len;
+    if (sock->pending_ranges_tail) {
+        sock->pending_ranges_tail->next = range;
+    } else {
+        sock->pending_ranges = range;
+    }
+    sock->pending_ranges_tail = range;
+    sock->pending_range_bytes += range->remaining;
+}
+
+bool NET_SendFileToStreamSocket(NET_StreamSocket *sock, SDL_IOStream *io, Sint64 offset, Sint64 len, bool closeio)
+{
+    bool retval = false;
+
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+    } else if (!io) {
+        SDL_InvalidParamError("io");
+    } else if (offset < 0) {
+        SDL_InvalidParamError("offset");
+    } else if (len < -1) {
+        SDL_InvalidParamError("len");
+    } else {
+        if (len == -1) {  // send everything from `offset` to the end of the file.
+            const Sint64 size = SDL_GetIOSize(io);
+            len = (size < 0) ? -1 : SDL_max(size - offset, 0);
+        }
+
+        NET_PendingRange *range = (len > 0) ? (NET_PendingRange *) SDL_calloc(1, sizeof (NET_PendingRange)) : NULL;
+        if (len == 0) {
+            retval = true;  // nothing to send.
+        } else if (range) {
+            range->io = io;
+            range->closeio = closeio;
+            range->fd = -1;
+            range->offset = offset;
+            range->remaining = len;
+            #ifdef USE_SENDFILE
+            if ((Sint64) (off_t) (offset + len) == (offset + len)) {  // (make sure sendfile() can reach the whole range.)
+                range->fd = (int) SDL_GetNumberProperty(SDL_GetIOProperties(io), SDL_PROP_IOSTREAM_FILE_DESCRIPTOR_NUMBER, -1);
+            }
+            #endif
+
+            if (LockStreamSocketOutput(sock)) {
+                AppendStreamSocketPendingRange(sock, range);
+                UnlockStreamSocketOutput(sock);
+                closeio = false;  // the range owns it now.
+                retval = PumpStreamSocketUnlessCorked(sock);  // start sending right away if we can.
+            } else {
+                SDL_free(range);
+            }
+        }
+    }
+
+    if (closeio && io) {
+        SDL_CloseIO(io);
+    }
+
+    return retval;
+}
+
+// writes smaller than this aren't worth the overhead of pinning pages and waiting for completions, so we just copy them.
+#define ZEROCOPY_MIN_SIZE (16 * 1024)
+
+// let go of finished zero-copy writes, oldest first. Must hold LockStreamSocketOutput!
+static void RetireZeroCopyWrites(NET_StreamSocket *sock)
+{
+    NET_ZeroCopyWrite *zc;
+    while ((zc = sock->zerocopy_writes) != NULL) {
+        if (!zc->issued) {
+            break;  // still waiting to go out.
+        } else if (zc->pinned && ((Sint32) (zc->last_send - sock->zerocopy_completed) >= 0)) {
+            break;  // the kernel is still using it.
+        }
+        sock->zerocopy_completed_id = zc->id;
+        sock->zerocopy_writes = zc->next;
+        if (!sock->zerocopy_writes) {
+            sock->zerocopy_writes_tail = NULL;
+        }
+        SDL_free(zc);
+    }
+}
+
+#ifdef USE_ZEROCOPY
+// collect notices from the socket's error queue about MSG_ZEROCOPY sends finishing. Returns true if there were any.
+//  Must hold LockStreamSocketOutput!
+static bool ReadZeroCopyCompletions(NET_StreamSocket *sock)
+{
+    bool retval = false;
+    while (true) {
+        Uint8 control[128];
+        struct msghdr msg;
+        SDL_zero(msg);
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof (control);
+        if (recvmsg(sock->handle, &msg, MSG_ERRQUEUE) < 0) {
+            break;  // queue is empty.
+        }
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (((cmsg->cmsg_level == SOL_IP) && (cmsg->cmsg_type == IP_RECVERR)) || ((cmsg->cmsg_level == SOL_IPV6) && (cmsg->cmsg_type == IPV6_RECVERR))) {
+                struct sock_extended_err serr;
+                SDL_memcpy(&serr, CMSG_DATA(cmsg), sizeof (serr));
+                if ((serr.ee_errno == 0) && (serr.ee_origin == SO_EE_ORIGIN_ZEROCOPY)) {
+                    // sends ee_info through ee_data are done. Stream sockets finish these in order.
+                    const Uint32 next = serr.ee_data + 1;
+                    if ((Sint32) (next - sock->zerocopy_completed) > 0) {
+                        sock->zerocopy_completed = next;
+                    }
+                    retval = true;
+                }
+            }
+        }
+    }
+
+    RetireZeroCopyWrites(sock);
+    return retval;
+}
+#endif
+
+Sint64 NET_WriteToStreamSocketZeroCopy(NET_StreamSocket *sock, const void *buf, int buflen)
+{
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+        return -1;
+    } else if (buf == NULL) {
+        SDL_InvalidParamError("buf");
+        return -1;
+    } else if (buflen < 0) {
+        SDL_InvalidParamError("buflen");
+        return -1;
+    }
+
+    NET_ZeroCopyWrite *zc = (NET_ZeroCopyWrite *) SDL_calloc(1, sizeof (NET_ZeroCopyWrite));
+    NET_PendingRange *range = NULL;
+    if (!zc) {
+        return -1;
+    } else if (!LockStreamSocketOutput(sock)) {
+        SDL_free(zc);
+        return -1;
+    }
+
+    if (buflen >= ZEROCOPY_MIN_SIZE) {
+        if ((sock->zerocopy_state == 0) && (sock->handle != INVALID_SOCKET)) {  // first big write? Try to turn on zero-copy for this socket.
+            #ifdef USE_ZEROCOPY
+            const int one = 1;
+            sock->zerocopy_state = (setsockopt(sock->handle, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof (one)) == 0) ? 1 : -1;
+            #else
+            sock->zerocopy_state = -1;
+            #endif
+        }
+
+        // even without MSG_ZEROCOPY, we borrow the app's buffer instead of copying it; it's just done once it's all been handed to the system.
+        range = (NET_PendingRange *) SDL_calloc(1, sizeof (NET_PendingRange));
+        if (!range) {
+            UnlockStreamSocketOutput(sock);
+            SDL_free(zc);
+            return -1;
+        }
+    }
+
+    const Sint64 id = ++sock->zerocopy_last_id;
+    zc->id = id;
+    zc->issued = (range == NULL);  // small writes get copied right away below, so they're free as soon as this returns.
+    if (sock->zerocopy_writes_tail) {
+        sock->zerocopy_writes_tail->next = zc;
+    } else {
+        sock->zerocopy_writes = zc;
+    }
+    sock->zerocopy_writes_tail = zc;
+
+    if (range) {
+        range->fd = -1;
+        range->buf = (const Uint8 *) buf;
+        range->zerocopy = zc;
+        range->remaining = buflen;
+        AppendStreamSocketPendingRange(sock, range);
+    }
+
+    UnlockStreamSocketOutput(sock);
+
+    bool rc;
+    if (range) {
+        rc = PumpStreamSocketUnlessCorked(sock);  // start sending right away if we can.
+    } else {
+        NET_IOVec iov;
+        iov.buf = (void *) buf;
+        iov.buflen = buflen;
+        rc = WriteToStreamSocketV(sock, &iov, 1, buflen);
+    }
+
+    return rc ? id : -1;
+}
+
+Sint64 NET_GetStreamSocketZeroCopyCompleted(NET_StreamSocket *sock)
+{
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+        return -1;
+    } else if (!PumpStreamSocket(sock)) {
+        return -1;
+    } else if (!LockStreamSocketOutput(sock)) {
+        return -1;
+    }
+
+    #ifdef USE_ZEROCOPY
+    if (sock->zerocopy_state > 0) {
+        ReadZeroCopyCompletions(sock);
+    }
+    #endif
+    RetireZeroCopyWrites(sock);
+    const Sint64 retval = sock->zerocopy_completed_id;
+
+    UnlockStreamSocketOutput(sock);
+
+    return retval;
+}
+
+bool NET_SetStreamSocketCorked(NET_StreamSocket *sock, bool corked)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    }
+    SDL_SetAtomicInt(&sock->corked, corked ? 1 : 0);
+    return corked ? true : PumpStreamSocket(sock);  // uncorking sends whatever built up.
+}
+
+bool NET_FlushStreamSocket(NET_StreamSocket *sock)
+{
+    return PumpStreamSocket(sock);  // queued writes are in one buffer, so they go out in one syscall, split only around file and zero-copy ranges.
+}
+
+int NET_GetStreamSocketPendingWrites(NET_StreamSocket *sock)
+{
+    if (!PumpStreamSocket(sock)) {
+        return -1;
+    }
+    return GetStreamSocketPendingOutputLen(sock);
+}
+
+bool NET_SetStreamSocketThreadSafeWrites(NET_StreamSocket *sock, bool enabled)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if (enabled && sock->race) {
+        return SDL_SetError("Can't enable thread-safe writes until the connection is made");  // the connection race changes `handle` behind the writers' backs.
+    } else if (enabled && !sock->threadsafe_writes) {
+        sock->wake_handle = CreateWakeSocket();
+        if (sock->wake_handle == INVALID_SOCKET) {
+            return false;  // error string was already set.
+        }
+        SDL_SetAtomicInt(&sock->wake_needed, 0);
+        SDL_SetAtomicInt(&sock->published_pending_output_len, GetStreamSocketQueuedOutputLen(sock));
+        sock->threadsafe_writes = true;
+    } else if (!enabled && sock->threadsafe_writes) {
+        // the app promises no other threads are writing now, so this lock won't be held for long, if at all.
+        SDL_LockSpinlock(&sock->pump_lock);
+        const bool retval = CollectStreamSocketWriteQueue(sock);
+        sock->threadsafe_writes = false;
+        SDL_UnlockSpinlock(&sock->pump_lock);
+        CloseSocketHandle(sock->wake_handle);
+        sock->wake_handle = INVALID_SOCKET;
+        return retval;
+    }
+    return true;
+}
+
+int NET_WaitUntilStreamSocketDrained(NET_StreamSocket *sock, int timeoutms)
+{
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+        return -1;
+    }
+
+    if (timeoutms != 0) {
+        const Uint64 endtime = (timeoutms > 0) ? (SDL_GetTicks() + timeoutms) : 0;
+        while (NET_GetStreamSocketPendingWrites(sock) > 0) {
+            const Uint64 lag = sock->threadsafe_writes ? 0 : StreamSocketSimulatedLagRemaining(sock, SDL_GetTicks());
+            if (sock->handle == INVALID_SOCKET) {  // still racing connection attempts, so there's nothing to poll until one of them wins.
+                const NET_Status status = CheckClientConnection(sock, timeoutms);
+                if (status == NET_FAILURE) {
+                    return -1;  // error string was already set.
+                } else if (status == NET_WAITING) {
+                    break;  // timed out
+                }
+            } else if (lag > 0) {  // the socket is probably writable, but we're simulating lag, so don't spin on it; just sleep until it's over.
+                if ((timeoutms > 0) && (lag >= (Uint64) timeoutms)) {
+                    SDL_Delay((Uint32) timeoutms);
+                    break;  // timed out
+                }
+                SDL_Delay((Uint32) lag);
+            } else {
+                struct pollfd pfd;
+                SDL_zero(pfd);
+                pfd.fd = sock->handle;
+                pfd.events = POLLOUT;
+                const int rc = poll(&pfd, 1, timeoutms);
+                if (rc == SOCKET_ERROR) {
+                    return SetLastSocketError("Socket poll failed");
+                } else if (rc == 0) {
+                    break;  // timed out
+                }
+            }
+
+            if (timeoutms > 0) {   // We must have woken up for a pending write, etc. Figure out remaining wait time.
+                const Uint64 now = SDL_GetTicks();
+                if (now < endtime) {
+                    timeoutms = (int) (endtime - now);
+                } else {
+                    break;  // time has expired, break out.
+                }
+            } // else timeout is meant to be infinite, but we woke up for a write, etc, so go back to an infinite poll until we fail or buffer is drained.
+        }
+    }
+
+    return NET_GetStreamSocketPendingWrites(sock);
+}
+
+// reads ahead of the app happen in chunks at least this big, so we make as few system calls as possible.
+#define STREAM_INPUT_CHUNK_SIZE (16 * 1024)
+
+// report a failure that was held back until the app consumed everything buffered before it.
+static int SetStreamSocketInputError(NET_StreamSocket *sock)
+{
+    SDL_assert(sock->input_error != 0);
+    if (sock->input_error < 0) {
+        SDL_SetError("End of stream");
+        return -1;
+    }
+    return SetSocketError("Failed to read from socket", sock->input_error);
+}
+
+static void ConsumeStreamSocketInputBuffer(NET_StreamSocket *sock, int len)
+{
+    SDL_assert(len <= sock->input_buffer_len);
+    sock->input_buffer_start += len;
+    sock->input_buffer_len -= len;
+    if (sock->input_buffer_len == 0) {
+        sock->input_buffer_start = 0;
+    }
+    sock->input_buffer_needs_more = false;  // whatever's left might be enough for the app's next request.
+    sock->input_buffer_reported = false;
+}
+
+// true if NET_WaitUntilInputAvailable should report this socket because of data (or a failure) we already read ahead.
+static bool StreamSocketHasBufferedInput(const NET_StreamSocket *sock, bool edge_triggered)
+{
+    if (edge_triggered && sock->input_buffer_reported) {
+        return false;
+    }
+    return ((sock->input_buffer_len > 0) || (sock->input_error != 0)) && !sock->input_buffer_needs_more;
+}
+
+// read from the socket into input_buffer until it holds at least `wanted` bytes or the socket would block.
+static bool FillStreamSocketInputBuffer(NET_StreamSocket *sock, int wanted)
+{
+    if (!PumpStreamSocketUnlessCorked(sock)) {  // try to flush any queued data to the socket now, before we go further.
+        return false;
+    } else if (sock->handle == INVALID_SOCKET) {
+        return (CheckStreamSocketHandle(sock) == 0);  // still racing connection attempts, so nothing to read yet.
+    } else if (sock->simulated_failure_until && (SDL_GetTicks() < sock->simulated_failure_until)) {
+        return true;  // streams are reliable, so instead of packet loss, we introduce lag.
+    }
+
+    while ((sock->input_buffer_len < wanted) && (sock->input_error == 0)) {
+        if (sock->input_buffer_start > 0) {  // slide unconsumed data to the front to make room.
+            SDL_memmove(sock->input_buffer, sock->input_buffer + sock->input_buffer_start, sock->input_buffer_len);
+            sock->input_buffer_start = 0;
+        }
+
+        const int min_alloc = sock->input_buffer_len + SDL_max(STREAM_INPUT_CHUNK_SIZE, wanted - sock->input_buffer_len);
+        if (min_alloc > sock->input_buffer_allocation) {
+            int newlen = SDL_max(STREAM_INPUT_CHUNK_SIZE, sock->input_buffer_allocation);
+            while (newlen < min_alloc) {
+                newlen *= 2;
+                if (newlen < 0) {  // uhoh, overflowed! That's a lot of memory!!
+                    return SDL_OutOfMemory();
+                }
+            }
+            void *ptr = SDL_realloc(sock->input_buffer, newlen);
+            if (!ptr) {
+                return false;
+            }
+            sock->input_buffer = (Uint8 *) ptr;
+            sock->input_buffer_allocation = newlen;
+        }
+
+        const int avail = sock->input_buffer_allocation - sock->input_buffer_len;
+        const int br = (int) read(sock->handle, (char *) sock->input_buffer + sock->input_buffer_len, avail);
+        if (br == 0) {
+            sock->input_error = -1;  // end of stream; the app gets this once the buffer is empty.
+        } else if (br < 0) {
+            const int err = LastSocketError();
+            if (WouldBlock(err)) {
+                sock->input_needs_drain = false;  // read everything available, so we're drained.
+                break;
+            }
+            sock->input_error = err;
+        } else {
+            sock->input_buffer_len += br;
+            sock->input_buffer_needs_more = false;
+            sock->input_buffer_reported = false;
+            UpdateStreamSocketSimulatedFailure(sock);
+            if (sock->simulated_failure_until) {
+                break;
             }
         }
     }
 
-    // queue this up for sending later.
-    const int min_alloc = sock->pending_output_len + buflen;
-    if (min_alloc > sock->pending_output_allocation) {
-        int newlen = SDL_max(1, sock->pending_output_allocation);
-        while (newlen < min_alloc) {
-            newlen *= 2;
-            if (newlen < 0) {  // uhoh, overflowed! That's a lot of memory!!
-                return SDL_OutOfMemory();
+    if ((sock->input_buffer_len == 0) && (sock->input_error != 0)) {
+        SetStreamSocketInputError(sock);
+        return false;
+    }
+
+    return true;
+}
+
+// read into `iov`, either once or (if `fill`) until it's full or the socket would block. Parameters have already been validated.
+static int ReadFromStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt, int buflen, bool fill)
+{
+    if (!PumpStreamSocketUnlessCorked(sock)) {  // try to flush any queued data to the socket now, before we go further.
+        return -1;
+    } else if (buflen == 0) {
+        return 0;  // nothing to do.
+    } else if (sock->handle == INVALID_SOCKET) {
+        return CheckStreamSocketHandle(sock);  // still racing connection attempts (so nothing to read yet), or they all failed.
+    }
+
+    int total = 0;
+    int first = 0;  // first buffer in `iov` that isn't full yet.
+    int skip = 0;  // bytes already filled in iov[first].
+
+    if (sock->input_buffer_len > 0) {  // hand over anything we read ahead for NET_PeekFromStreamSocket, etc, first.
+        for (int i = 0; (i < iovcnt) && (sock->input_buffer_len > 0); i++) {
+            const int cpy = SDL_min(iov[i].buflen, sock->input_buffer_len);
+            if (cpy > 0) {
+                SDL_memcpy(iov[i].buf, sock->input_buffer + sock->input_buffer_start, cpy);
+                ConsumeStreamSocketInputBuffer(sock, cpy);
+                total += cpy;
             }
         }
-        void *ptr = SDL_realloc(sock->pending_output_buffer, newlen);
-        if (!ptr) {
-            return false;
+
+        if (!fill || (total == buflen) || sock->input_error) {
+            return total;  // (if there's an error waiting, the app gets it after the buffer is empty.)
         }
-        sock->pending_output_buffer = (Uint8 *) ptr;
-        sock->pending_output_allocation = newlen;
+
+        skip = total;
+        while ((first < iovcnt) && (skip >= iov[first].buflen)) {
+            skip -= iov[first].buflen;
+            first++;
+        }
+    } else if (sock->input_error) {
+        return SetStreamSocketInputError(sock);
+    }
+
+    if (sock->simulated_failure_until && (SDL_GetTicks() < sock->simulated_failure_until)) {
+        return total;  // streams are reliable, so instead of packet loss, we introduce lag.
     }
 
-    SDL_memcpy(sock->pending_output_buffer + sock->pending_output_len, buf, buflen);
-    sock->pending_output_len += buflen;
+    while (total < buflen) {
+        NET_IOVec window[MAX_IOVECS_PER_SYSCALL];
+        const int count = SDL_min(iovcnt - first, MAX_IOVECS_PER_SYSCALL);
+        SDL_memcpy(window, iov + first, count * sizeof (NET_IOVec));
+        window[0].buf = ((Uint8 *) window[0].buf) + skip;
+        window[0].buflen -= skip;
 
-    return true;
+        const int br = SocketReadV(sock->handle, window, count);
+        if (br == 0) {
+            if (total > 0) {
+                break;  // hand over what we got; the app will see the end of stream on the next read.
+            }
+            SDL_SetError("End of stream");
+            return -1;
+        } else if (br < 0) {
+            const int err = LastSocketError();
+            if (WouldBlock(err)) {
+                sock->input_needs_drain = false;  // read everything available, so we're drained.
+                break;
+            } else if (total > 0) {
+                break;  // hand over what we got; the app will see the failure on the next read.
+            }
+            return SetSocketError("Failed to read from socket", err);
+        }
+
+        total += br;
+
+        UpdateStreamSocketSimulatedFailure(sock);
+
+        if (!fill || sock->simulated_failure_until) {
+            break;
+        }
+
+        skip += br;
+        while ((first < iovcnt) && (skip >= iov[first].buflen)) {
+            skip -= iov[first].buflen;
+            first++;
+        }
+    }
+
+    return total;
 }
 
-int NET_GetStreamSocketPendingWrites(NET_StreamSocket *sock)
+int NET_ReadFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen)
 {
-    if (!PumpStreamSocket(sock)) {
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+        return -1;
+    } else if (buf == NULL) {
+        SDL_InvalidParamError("buf");
+        return -1;
+    } else if (buflen < 0) {
+        SDL_InvalidParamError("buflen");
         return -1;
     }
-    return sock->pending_output_len;
+
+    NET_IOVec iov;
+    iov.buf = buf;
+    iov.buflen = buflen;
+    return ReadFromStreamSocketV(sock, &iov, 1, buflen, false);
 }
 
-int NET_WaitUntilStreamSocketDrained(NET_StreamSocket *sock, int timeoutms)
+int NET_ReadFromStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt)
 {
     if (!sock) {
         SDL_InvalidParamError("sock");
         return -1;
     }
 
-    if (timeoutms != 0) {
-        const Uint64 endtime = (timeoutms > 0) ? (SDL_GetTicks() + timeoutms) : 0;
-        while (NET_GetStreamSocketPendingWrites(sock) > 0) {
-            struct pollfd pfd;
-            SDL_zero(pfd);
-            pfd.fd = sock->handle;
-            pfd.events = POLLOUT;
-            const int rc = poll(&pfd, 1, timeoutms);
-            if (rc == SOCKET_ERROR) {
-                return SetLastSocketError("Socket poll failed");
-            } else if (rc == 0) {
-                break;  // timed out
-            }
+    const int buflen = GetIOVecTotalLength(iov, iovcnt);
+    if (buflen < 0) {
+        return -1;
+    }
 
-            if (timeoutms > 0) {   // We must have woken up for a pending write, etc. Figure out remaining wait time.
-                const Uint64 now = SDL_GetTicks();
-                if (now < endtime) {
-                    timeoutms = (int) (endtime - now);
-                } else {
-                    break;  // time has expired, break out.
-                }
-            } // else timeout is meant to be infinite, but we woke up for a write, etc, so go back to an infinite poll until we fail or buffer is drained.
+    return ReadFromStreamSocketV(sock, iov, iovcnt, buflen, false);
+}
+
+int NET_FillFromStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt)
+{
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+        return -1;
+    }
+
+    const int buflen = GetIOVecTotalLength(iov, iovcnt);
+    if (buflen < 0) {
+        return -1;
+    }
+
+    return ReadFromStreamSocketV(sock, iov, iovcnt, buflen, true);
+}
+
+int NET_PeekFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen)
+{
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+        return -1;
+    } else if (buf == NULL) {
+        SDL_InvalidParamError("buf");
+        return -1;
+    } else if (buflen < 0) {
+        SDL_InvalidParamError("buflen");
+        return -1;
+    } else if (!FillStreamSocketInputBuffer(sock, buflen)) {
+        return -1;
+    }
+
+    const int len = SDL_min(buflen, sock->input_buffer_len);
+    if (len > 0) {
+        SDL_memcpy(buf, sock->input_buffer + sock->input_buffer_start, len);
+    }
+    return len;
+}
+
+// find `delim` in the first `maxlen` bytes of input_buffer. Returns the number of bytes up to and including the delimiter, or 0 if not found.
+static int FindStreamSocketDelimiter(const NET_StreamSocket *sock, const Uint8 *delim, int delimlen, int maxlen)
+{
+    const Uint8 *start = sock->input_buffer + sock->input_buffer_start;
+    const Uint8 *ptr = start;
+    const Uint8 *end = start + SDL_min(maxlen, sock->input_buffer_len);
+
+    while ((end - ptr) >= delimlen) {
+        // let the C runtime's (usually vectorized) memchr find candidates for the first byte, then check the rest.
+        ptr = (const Uint8 *) memchr(ptr, delim[0], (size_t) ((end - ptr) - delimlen) + 1);
+        if (!ptr) {
+            break;
+        } else if (SDL_memcmp(ptr + 1, delim + 1, delimlen - 1) == 0) {
+            return (int) ((ptr - start) + delimlen);
         }
+        ptr++;
     }
 
-    return NET_GetStreamSocketPendingWrites(sock);
+    return 0;
 }
 
-int NET_ReadFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen)
+int NET_ReadFromStreamSocketUntil(NET_StreamSocket *sock, const void *delim, int delimlen, void *buf, int buflen)
 {
-    if (!PumpStreamSocket(sock)) {  // try to flush any queued data to the socket now, before we go further.
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+        return -1;
+    } else if (delim == NULL) {
+        SDL_InvalidParamError("delim");
+        return -1;
+    } else if (delimlen <= 0) {
+        SDL_InvalidParamError("delimlen");
+        return -1;
+    } else if (buf == NULL) {
+        SDL_InvalidParamError("buf");
+        return -1;
+    } else if (buflen < delimlen) {
+        SDL_InvalidParamError("buflen");
         return -1;
-    } else if (sock->simulated_failure_until && (SDL_GetTicks() < sock->simulated_failure_until)) {
-        return 0;  // streams are reliable, so instead of packet loss, we introduce lag.
     }
 
-    if (buf == NULL) {
-        return SDL_InvalidParamError("buf");
+    // check what we already have first, so we don't read more than we have to.
+    int len = FindStreamSocketDelimiter(sock, (const Uint8 *) delim, delimlen, buflen);
+    while ((len == 0) && (sock->input_buffer_len < buflen) && (sock->input_error == 0)) {
+        const int oldlen = sock->input_buffer_len;
+        if (!FillStreamSocketInputBuffer(sock, oldlen + 1)) {
+            return -1;
+        } else if (sock->input_buffer_len == oldlen) {
+            break;  // nothing new right now.
+        }
+        len = FindStreamSocketDelimiter(sock, (const Uint8 *) delim, delimlen, buflen);
+    }
+
+    if (len == 0) {
+        if (sock->input_buffer_len >= buflen) {
+            SDL_SetError("Delimiter not found in the first %d bytes", buflen);
+            return -1;
+        } else if (sock->input_error) {
+            return SetStreamSocketInputError(sock);  // the delimiter is never going to show up now.
+        }
+        sock->input_buffer_needs_more = true;
+        return 0;
+    }
+
+    SDL_memcpy(buf, sock->input_buffer + sock->input_buffer_start, len);
+    ConsumeStreamSocketInputBuffer(sock, len);
+    return len;
+}
+
+int NET_ReadExactFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen)
+{
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+        return -1;
+    } else if (buf == NULL) {
+        SDL_InvalidParamError("buf");
+        return -1;
     } else if (buflen < 0) {
-        return SDL_InvalidParamError("buflen");
+        SDL_InvalidParamError("buflen");
+        return -1;
     } else if (buflen == 0) {
         return 0;  // nothing to do.
+    } else if (!FillStreamSocketInputBuffer(sock, buflen)) {
+        return -1;
+    } else if (sock->input_buffer_len < buflen) {
+        if (sock->input_error) {
+            return SetStreamSocketInputError(sock);  // the rest is never going to show up now.
+        }
+        sock->input_buffer_needs_more = true;
+        return 0;
     }
 
-    const int br = (int) read(sock->handle, buf, buflen);
-    if (br == 0) {
-        SDL_SetError("End of stream");
-        return -1;
-    } else if (br < 0) {
-        const int err = LastSocketError();
-        return WouldBlock(err) ? 0 : SetSocketError("Failed to read from socket", err);
+    SDL_memcpy(buf, sock->input_buffer + sock->input_buffer_start, buflen);
+    ConsumeStreamSocketInputBuffer(sock, buflen);
+    return buflen;
+}
+
+// messages are a 32-bit big-endian length, followed by that many bytes of payload.
+#define MESSAGE_HEADER_SIZE 4
+#define DEFAULT_MAX_MESSAGE_SIZE (16 * 1024 * 1024)
+
+bool NET_SendMessage(NET_StreamSocket *sock, const void *buf, int buflen)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if (!buf && (buflen > 0)) {
+        return SDL_InvalidParamError("buf");
+    } else if ((buflen < 0) || (buflen > (SDL_MAX_SINT32 - MESSAGE_HEADER_SIZE))) {
+        return SDL_InvalidParamError("buflen");
     }
 
-    UpdateStreamSocketSimulatedFailure(sock);
+    // the header and payload go out in one writev(), and get queued together if the socket can't take them yet.
+    const Uint32 header = SDL_Swap32BE((Uint32) buflen);
+    NET_IOVec iov[2];
+    iov[0].buf = (void *) &header;
+    iov[0].buflen = MESSAGE_HEADER_SIZE;
+    iov[1].buf = (void *) buf;
+    iov[1].buflen = buflen;
+    return WriteToStreamSocketV(sock, iov, 2, MESSAGE_HEADER_SIZE + buflen);
+}
 
-    return br;
+bool NET_ReceiveMessage(NET_StreamSocket *sock, const void **buf, int *buflen)
+{
+    if (buf) {
+        *buf = NULL;
+    }
+    if (buflen) {
+        *buflen = 0;
+    }
+
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if (!buf) {
+        return SDL_InvalidParamError("buf");
+    } else if (!buflen) {
+        return SDL_InvalidParamError("buflen");
+    } else if (!FillStreamSocketInputBuffer(sock, MESSAGE_HEADER_SIZE)) {
+        return false;
+    }
+
+    int total = MESSAGE_HEADER_SIZE;
+    if (sock->input_buffer_len >= MESSAGE_HEADER_SIZE) {
+        Uint32 header;
+        SDL_memcpy(&header, sock->input_buffer + sock->input_buffer_start, sizeof (header));
+        header = SDL_Swap32BE(header);
+
+        const int maxlen = sock->max_message_size ? sock->max_message_size : DEFAULT_MAX_MESSAGE_SIZE;
+        if (header > (Uint32) maxlen) {
+            return SDL_SetError("Incoming message is too large (%u bytes, the limit is %d)", (unsigned int) header, maxlen);
+        }
+
+        total += (int) header;
+        if (!FillStreamSocketInputBuffer(sock, total)) {
+            return false;
+        }
+    }
+
+    if (sock->input_buffer_len < total) {
+        if (sock->input_error) {
+            SetStreamSocketInputError(sock);  // the rest of the message is never going to show up now.
+            return false;
+        }
+        sock->input_buffer_needs_more = true;
+        return true;  // no complete message yet.
+    }
+
+    // hand out a pointer right into the input buffer. It stays put until the next time we read from this socket.
+    *buf = sock->input_buffer + sock->input_buffer_start + MESSAGE_HEADER_SIZE;
+    *buflen = total - MESSAGE_HEADER_SIZE;
+    ConsumeStreamSocketInputBuffer(sock, total);
+    return true;
+}
+
+bool NET_SetStreamSocketMaxMessageSize(NET_StreamSocket *sock, int maxlen)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if ((maxlen < 0) || (maxlen > (SDL_MAX_SINT32 - MESSAGE_HEADER_SIZE))) {
+        return SDL_InvalidParamError("maxlen");
+    }
+    sock->max_message_size = maxlen ? maxlen : DEFAULT_MAX_MESSAGE_SIZE;
+    return true;
 }
 
 void NET_SimulateStreamPacketLoss(NET_StreamSocket *sock, int percent_loss)
@@ -2070,11 +3926,32 @@ void NET_DestroyStreamSocket(NET_StreamSocket *sock)
     if (sock) {
         PumpStreamSocket(sock);  // try one last time to send any last pending data.
 
+        FreeConnectRace(sock->race);
         NET_UnrefAddress(sock->addr);
         if (sock->handle != INVALID_SOCKET) {
             CloseSocketHandle(sock->handle);  // !!! FIXME: what does this do with non-blocking sockets? Release the descriptor but the kernel continues sending queued buffers behind the scenes?
         }
+        if (sock->threadsafe_writes) {
+            CloseSocketHandle(sock->wake_handle);
+        }
+        NET_StreamWriteNode *node = (NET_StreamWriteNode *) SDL_SetAtomicPointer(&sock->write_queue, NULL);
+        while (node) {  // only thread-safe mode uses this, and only if the last pump couldn't get to everything.
+            NET_StreamWriteNode *next = node->next;
+            SDL_free(node);
+            node = next;
+        }
+        while (sock->pending_ranges) {
+            NET_PendingRange *next = sock->pending_ranges->next;
+            FreePendingRange(sock->pending_ranges);
+            sock->pending_ranges = next;
+        }
+        while (sock->zerocopy_writes) {
+            NET_ZeroCopyWrite *next = sock->zerocopy_writes->next;
+            SDL_free(sock->zerocopy_writes);
+            sock->zerocopy_writes = next;
+        }
         SDL_free(sock->pending_output_buffer);
+        SDL_free(sock->input_buffer);
         SDL_free(sock);
     }
 }
@@ -2085,8 +3962,17 @@ typedef struct NET_DatagramSocketHandle
     int family;
     int protocol;
     NET_Address *broadcast;
+    Uint32 drops;  // the latest count of overflowed packets the system reported for this handle (SO_RXQ_OVFL).
 } NET_DatagramSocketHandle;
 
+// a precomputed place to send broadcast packets; only the port changes between sends.
+typedef struct NET_BroadcastTarget
+{
+    int handle_idx;  // index into `handles` to send through.
+    AddressStorage saddr;
+    SockLen saddrlen;
+} NET_BroadcastTarget;
+
 struct NET_DatagramSocket
 {
     NET_SocketType socktype;
@@ -2103,6 +3989,24 @@ struct NET_DatagramSocket
     int pending_output_len;
     int pending_output_allocation;
     bool allow_broadcast;
+    NET_BroadcastTarget *broadcast_targets;  // built on first broadcast, and rebuilt when the network interfaces change.
+    int num_broadcast_targets;
+    int broadcast_targets_generation;
+    bool broadcast_targets_built;
+    bool udp_segment_unsupported;  // the kernel (or the network device) refused UDP_SEGMENT, so split datagrams ourselves from now on.
+    NET_Address *coalesced_addr;  // sender of a merged (UDP_GRO) packet in recv_buffer that we're still handing out one segment at a time.
+    Uint16 coalesced_port;
+    int coalesced_len;
+    int coalesced_offset;
+    int coalesced_segment_size;
+    SDL_Time coalesced_timestamp;
+    NET_ECN coalesced_ecn;
+    NET_Address *peer_addr;  // set by NET_ConnectDatagramSocket; packets to and from here skip the usual address lookups.
+    Uint16 peer_port;
+    int peer_handle;  // index into `handles` of the connected one, or -1 if not connected.
+    AddressStorage peer_saddr;
+    SockLen peer_saddrlen;
+    bool input_needs_drain;  // reported by NET_WaitUntilNewInputAvailable, but not received until it would block yet.
 };
 
 static NET_Address *FindBroadcastAddress(struct addrinfo *ainfo, Uint32 *interface_index)
@@ -2129,34 +4033,115 @@ static NET_Address *FindBroadcastAddress(struct addrinfo *ainfo, Uint32 *interfa
         }
     }
 
-    if (!ni) {
+    if (!ni) {
+        SDL_SetError("Not a network interface address");
+    } else {
+        SDL_assert(ni->address != NULL);
+        *interface_index = ni->index;
+        if (ni->broadcast != NULL) {
+            retval = NET_RefAddress(ni->broadcast);  // we calculated the broadcast address when discovering this interface. It's probably IPv4. We're good to go.
+        } else if (ainfo->ai_family == AF_INET6) {   // we fake this for IPv6 on the all-nodes link-local multicast group.
+            retval = NET_RefAddress(ipv6_broadcast_addr);
+        } else {
+            SDL_SetError("Can't determine broadcast address for this interface");
+        }
+    }
+
+    SDL_UnlockRWLock(interface_rwlock);
+
+    if (!retval && (ainfo->ai_family == AF_INET6)) {   // we fake this for IPv6 on the all-nodes link-local multicast group.
+        retval = NET_RefAddress(ipv6_broadcast_addr);
+    }
+
+    return retval;
+}
+
+#ifndef SDL_PLATFORM_VITA
+static bool FindInterfaceIndex(const NET_Address *addr, Uint32 *interface_index)
+{
+    if (!InterfacesReady()) {
+        return false;
+    }
+
+    bool found = false;
+    SDL_LockRWLockForReading(interface_rwlock);
+    for (int i = 0; i < num_interfaces; i++) {
+        if (NET_CompareAddresses(addr, interfaces[i].address) == 0) {
+            *interface_index = interfaces[i].index;
+            found = true;
+            break;
+        }
+    }
+    SDL_UnlockRWLock(interface_rwlock);
+
+    if (!found) {
         SDL_SetError("Not a network interface address");
-    } else {
-        SDL_assert(ni->address != NULL);
-        *interface_index = ni->index;
-        if (ni->broadcast != NULL) {
-            retval = NET_RefAddress(ni->broadcast);  // we calculated the broadcast address when discovering this interface. It's probably IPv4. We're good to go.
-        } else if (ainfo->ai_family == AF_INET6) {   // we fake this for IPv6 on the all-nodes link-local multicast group.
-            retval = NET_RefAddress(ipv6_broadcast_addr);
-        } else {
-            SDL_SetError("Can't determine broadcast address for this interface");
+    }
+    return found;
+}
+
+// multicast packets go out through the interface the socket is bound to, instead of wherever the routing table says.
+static void SetMulticastInterface(Socket handle, const struct addrinfo *ainfo)
+{
+    if (ainfo->ai_family == AF_INET) {
+        const struct in_addr *inaddr = &((const struct sockaddr_in *) ainfo->ai_addr)->sin_addr;
+        setsockopt(handle, IPPROTO_IP, IP_MULTICAST_IF, (const char *) inaddr, (SockLen) sizeof (*inaddr));  // if this fails, oh well.
+    } else if (ainfo->ai_family == AF_INET6) {
+        NET_Address *addr = CreateSDLNetAddrFromSockAddr(ainfo->ai_addr, (SockLen) ainfo->ai_addrlen);
+        Uint32 interface_index = 0;
+        if (addr && FindInterfaceIndex(addr, &interface_index)) {
+            const int ifidx = (int) interface_index;
+            setsockopt(handle, IPPROTO_IPV6, IPV6_MULTICAST_IF, (const char *) &ifidx, (SockLen) sizeof (ifidx));  // if this fails, oh well.
         }
+        NET_UnrefAddress(addr);
     }
+}
 
-    SDL_UnlockRWLock(interface_rwlock);
+// IPv4 multicast options are a single byte on the BSDs (Linux takes either), but WinSock wants a DWORD. IPv6 ones are always an int.
+static bool SetMulticastOption(Socket handle, int family, int ipv4_optname, int ipv6_optname, int value, const char *errmsg)
+{
+    if (value < 0) {
+        return true;  // not specified, leave the system default alone.
+    } else if (family == AF_INET6) {
+        return SetSocketOption(handle, IPPROTO_IPV6, ipv6_optname, value, errmsg);
+    }
 
-    if (!retval && (ainfo->ai_family == AF_INET6)) {   // we fake this for IPv6 on the all-nodes link-local multicast group.
-        retval = NET_RefAddress(ipv6_broadcast_addr);
+    #ifdef SDL_PLATFORM_WINDOWS
+    return SetSocketOption(handle, IPPROTO_IP, ipv4_optname, value, errmsg);
+    #else
+    const unsigned char byte = (unsigned char) value;
+    if (setsockopt(handle, IPPROTO_IP, ipv4_optname, (const char *) &byte, sizeof (byte)) == SOCKET_ERROR) {
+        return SetSocketErrorBool(errmsg, LastSocketError());
     }
+    return true;
+    #endif
+}
+#endif
 
-    return retval;
+// privileged processes can go past the system-wide buffer limit with the FORCE variants (on Linux), so try those first.
+static bool SetSocketBufferSize(Socket handle, int optname, int force_optname, int size, const char *errmsg)
+{
+    if ((size >= 0) && (force_optname >= 0) && (setsockopt(handle, SOL_SOCKET, force_optname, (const char *) &size, sizeof (size)) == 0)) {
+        return true;
+    }
+    return SetSocketOption(handle, SOL_SOCKET, optname, size, errmsg);
 }
 
 NET_DatagramSocket *NET_CreateDatagramSocket(NET_Address *addr, Uint16 port, SDL_PropertiesID props)
 {
+    const bool reuseport = SDL_GetBooleanProperty(props, NET_PROP_DATAGRAM_SOCKET_REUSEPORT_BOOLEAN, false);
+    const int multicast_ttl = GetOptionalNumberProperty(props, NET_PROP_DATAGRAM_SOCKET_MULTICAST_TTL_NUMBER);
+    const int multicast_loop = GetOptionalBooleanProperty(props, NET_PROP_DATAGRAM_SOCKET_MULTICAST_LOOPBACK_BOOLEAN);
+
     if (addr && (((NET_Status) SDL_GetAtomicInt(&addr->status)) != NET_SUCCESS)) {
         SDL_SetError("Address is not resolved");  // strictly speaking, this should be a local interface, but a resolved address can fail later.
         return NULL;
+    } else if (reuseport && (port == 0)) {
+        SDL_SetError("Sharing a datagram socket's port requires a specific port, not zero");  // otherwise each socket gets a different random port.
+        return NULL;
+    } else if (multicast_ttl > 255) {
+        SDL_SetError("Multicast TTL must be between 0 and 255");
+        return NULL;
     }
 
     struct addrinfo *addrwithport = MakeAddrInfoWithPort(addr, SOCK_DGRAM, port);
@@ -2173,9 +4158,15 @@ NET_DatagramSocket *NET_CreateDatagramSocket(NET_Address *addr, Uint16 port, SDL
     sock->socktype = SOCKETTYPE_DATAGRAM;
     sock->addr = addr;
     sock->port = port;
+    sock->peer_handle = -1;
 
     const int reuseaddr = SDL_GetBooleanProperty(props, NET_PROP_DATAGRAM_SOCKET_REUSEADDR_BOOLEAN, true) ? 1 : 0;
     sock->allow_broadcast = SDL_GetBooleanProperty(props, NET_PROP_DATAGRAM_SOCKET_ALLOW_BROADCAST_BOOLEAN, false);
+    const bool gro = SDL_GetBooleanProperty(props, NET_PROP_DATAGRAM_SOCKET_GRO_BOOLEAN, false);
+    const bool timestamps = SDL_GetBooleanProperty(props, NET_PROP_DATAGRAM_SOCKET_TIMESTAMPS_BOOLEAN, false);
+    const int send_buffer_size = GetOptionalNumberProperty(props, NET_PROP_DATAGRAM_SOCKET_SEND_BUFFER_SIZE_NUMBER);
+    const int receive_buffer_size = GetOptionalNumberProperty(props, NET_PROP_DATAGRAM_SOCKET_RECEIVE_BUFFER_SIZE_NUMBER);
+    const bool receive_ecn = SDL_GetBooleanProperty(props, NET_PROP_DATAGRAM_SOCKET_RECEIVE_ECN_BOOLEAN, false);
 
     const int bcast = sock->allow_broadcast ? 1 : 0;
 
@@ -2239,11 +4230,80 @@ NET_DatagramSocket *NET_CreateDatagramSocket(NET_Address *addr, Uint16 port, SDL
         setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, (const char *) &reuseaddr, sizeof (reuseaddr));
         setsockopt(handle, SOL_SOCKET, SO_BROADCAST, (const char *) &bcast, sizeof (bcast));
 
+        #ifdef SO_SNDBUFFORCE
+        const int sndbuf_force = SO_SNDBUFFORCE;
+        #else
+        const int sndbuf_force = -1;
+        #endif
+        #ifdef SO_RCVBUFFORCE
+        const int rcvbuf_force = SO_RCVBUFFORCE;
+        #else
+        const int rcvbuf_force = -1;
+        #endif
+        if (!SetSocketBufferSize(handle, SO_SNDBUF, sndbuf_force, send_buffer_size, "Failed to set SO_SNDBUF")) {
+            goto failed;
+        } else if (!SetSocketBufferSize(handle, SO_RCVBUF, rcvbuf_force, receive_buffer_size, "Failed to set SO_RCVBUF")) {
+            goto failed;
+        }
+
+        #ifdef USE_SO_RXQ_OVFL
+        {
+            const int one = 1;
+            setsockopt(handle, SOL_SOCKET, SO_RXQ_OVFL, (const char *) &one, sizeof (one));  // if this fails, oh well, we just can't count dropped packets.
+        }
+        #endif
+
+        if (reuseport && !EnableReusePort(handle)) {
+            goto failed;  // error string was already set.
+        }
+
+        #ifdef USE_UDP_GRO
+        if (gro) {
+            const int one = 1;
+            setsockopt(handle, SOL_UDP, UDP_GRO, (const char *) &one, sizeof (one));  // if this fails, oh well, we'll just get one packet at a time.
+        }
+        #else
+        (void) gro;
+        #endif
+
+        #ifdef USE_SO_TIMESTAMPNS
+        if (timestamps) {
+            const int one = 1;
+            setsockopt(handle, SOL_SOCKET, SO_TIMESTAMPNS, (const char *) &one, sizeof (one));  // if this fails, oh well, datagrams will report a zero timestamp.
+        }
+        #else
+        (void) timestamps;
+        #endif
+
+        #ifdef USE_RECVMSG
+        if (receive_ecn) {
+            const int one = 1;
+            if (ainfo->ai_family == AF_INET) {
+                setsockopt(handle, IPPROTO_IP, IP_RECVTOS, (const char *) &one, sizeof (one));  // if this fails, oh well, datagrams will report NET_ECN_NOT_ECT.
+            } else if (ainfo->ai_family == AF_INET6) {
+                setsockopt(handle, IPPROTO_IPV6, IPV6_RECVTCLASS, (const char *) &one, sizeof (one));  // if this fails, oh well, datagrams will report NET_ECN_NOT_ECT.
+            }
+        }
+        #else
+        (void) receive_ecn;
+        #endif
+
         if (ainfo->ai_family == AF_INET6) {
             const int one = 1;
             setsockopt(handle, IPPROTO_IPV6, IPV6_V6ONLY, (const char *) &one, sizeof (one));  // if this fails, oh well.
         }
 
+        #ifndef SDL_PLATFORM_VITA
+        if (!SetMulticastOption(handle, ainfo->ai_family, IP_MULTICAST_TTL, IPV6_MULTICAST_HOPS, multicast_ttl, "Failed to set multicast TTL")) {
+            goto failed;
+        } else if (!SetMulticastOption(handle, ainfo->ai_family, IP_MULTICAST_LOOP, IPV6_MULTICAST_LOOP, multicast_loop, "Failed to set multicast loopback")) {
+            goto failed;
+        }
+        #else
+        (void) multicast_ttl;
+        (void) multicast_loop;
+        #endif
+
         const int rc = bind(handle, ainfo->ai_addr, (SockLen) ainfo->ai_addrlen);
         if (rc == SOCKET_ERROR) {
             const int err = LastSocketError();
@@ -2252,6 +4312,12 @@ NET_DatagramSocket *NET_CreateDatagramSocket(NET_Address *addr, Uint16 port, SDL
             goto failed;
         }
 
+        #ifndef SDL_PLATFORM_VITA
+        if (addr) {
+            SetMulticastInterface(handle, ainfo);
+        }
+        #endif
+
         if (sock->allow_broadcast) {
             Uint32 interface_index = 0;  // this will stay zero for INADDR6_ANY, to pick a default interface.
             socket_handle->broadcast = FindBroadcastAddress(ainfo, &interface_index);
@@ -2279,32 +4345,400 @@ NET_DatagramSocket *NET_CreateDatagramSocket(NET_Address *addr, Uint16 port, SDL
                     SDL_SetError("Failed to join all-nodes link-local multicast group for broadcasting");
                     goto failed;
                 }
-                const int ifidx = (int) interface_index;
-                setsockopt(handle, IPPROTO_IPV6, IPV6_MULTICAST_IF, (const char *) &ifidx, (SockLen) sizeof (ifidx));  // multicast sends go through the same interface.
-#endif
+                const int ifidx = (int) interface_index;
+                setsockopt(handle, IPPROTO_IPV6, IPV6_MULTICAST_IF, (const char *) &ifidx, (SockLen) sizeof (ifidx));  // multicast sends go through the same interface.
+#endif
+            }
+        }
+    }
+
+    freeaddrinfo(addrwithport);
+
+    NET_RefAddress(addr);
+    return sock;
+
+failed:
+    for (int i = 0; i < sock->num_handles; i++) {
+        CloseSocketHandle(sock->handles[i].handle);
+        NET_UnrefAddress(sock->handles[i].broadcast);
+    }
+    freeaddrinfo(addrwithport);
+    SDL_free(allocated_handles);
+    SDL_free(sock);
+    return NULL;
+}
+
+static Uint16 GetLocalSocketPort(Socket handle)
+{
+    AddressStorage local;
+    SockLen locallen = sizeof (local);
+    if (getsockname(handle, (struct sockaddr *) &local, &locallen) == SOCKET_ERROR) {
+        return 0;
+    } else if (((const struct sockaddr *) &local)->sa_family == AF_INET) {
+        return ntohs(((const struct sockaddr_in *) &local)->sin_port);
+    } else if (((const struct sockaddr *) &local)->sa_family == AF_INET6) {
+        return ntohs(((const struct sockaddr_in6 *) &local)->sin6_port);
+    }
+    return 0;
+}
+
+// dissolve a datagram socket's association with its peer, so it receives packets from anywhere again.
+static void DisconnectDatagramSocket(NET_DatagramSocket *sock)
+{
+    const NET_DatagramSocketHandle *handle = &sock->handles[sock->peer_handle];
+
+    // Linux gives up a system-assigned port when a datagram socket disconnects, so note it so we can bind back to it.
+    const Uint16 localport = (sock->port == 0) ? GetLocalSocketPort(handle->handle) : 0;
+
+    AddressStorage unspec;
+    SDL_zero(unspec);
+    #ifdef SDL_PLATFORM_WINDOWS
+    unspec.ss_family = (ADDRESS_FAMILY) handle->family;  // WinSock dissolves the association when connecting to an all-zeros address.
+    #else
+    unspec.ss_family = AF_UNSPEC;
+    #endif
+    connect(handle->handle, (const struct sockaddr *) &unspec, (SockLen) sizeof (unspec));  // if this fails, oh well.
+
+    if ((localport != 0) && (GetLocalSocketPort(handle->handle) == 0)) {
+        struct addrinfo *addrwithport = MakeAddrInfoWithPort(sock->addr, SOCK_DGRAM, localport);
+        for (struct addrinfo *ainfo = addrwithport; ainfo != NULL; ainfo = ainfo->ai_next) {
+            if (ainfo->ai_family == handle->family) {
+                bind(handle->handle, ainfo->ai_addr, (SockLen) ainfo->ai_addrlen);  // if this fails, oh well, we'll get a new port on the next send.
+                break;
+            }
+        }
+        if (addrwithport) {
+            freeaddrinfo(addrwithport);
+        }
+    }
+
+    NET_UnrefAddress(sock->peer_addr);
+    sock->peer_addr = NULL;
+    sock->peer_port = 0;
+    sock->peer_handle = -1;
+}
+
+bool NET_ConnectDatagramSocket(NET_DatagramSocket *sock, NET_Address *addr, Uint16 port)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if (addr && (((NET_Status) SDL_GetAtomicInt(&addr->status)) != NET_SUCCESS)) {
+        return SDL_SetError("Address is not resolved");
+    }
+
+    if (!addr) {
+        if (sock->peer_handle >= 0) {
+            DisconnectDatagramSocket(sock);
+        }
+        return true;
+    }
+
+    struct addrinfo *addrwithport = MakeAddrInfoWithPort(addr, SOCK_DGRAM, port);
+    if (!addrwithport) {
+        return false;
+    }
+
+    int handle_idx = -1;
+    for (int i = 0; i < sock->num_handles; i++) {
+        if ((sock->handles[i].family == addrwithport->ai_family) && (sock->handles[i].protocol == addrwithport->ai_protocol)) {
+            handle_idx = i;
+            break;
+        }
+    }
+
+    if (handle_idx < 0) {
+        freeaddrinfo(addrwithport);
+        return SDL_SetError("Unsupported network family in destination address");
+    }
+
+    // connecting an already-connected socket just switches peers, but a different handle means the old one has to let go.
+    if ((sock->peer_handle >= 0) && (sock->peer_handle != handle_idx)) {
+        DisconnectDatagramSocket(sock);
+    }
+
+    if (connect(sock->handles[handle_idx].handle, addrwithport->ai_addr, (SockLen) addrwithport->ai_addrlen) == SOCKET_ERROR) {
+        const int err = LastSocketError();
+        freeaddrinfo(addrwithport);
+        if (sock->peer_handle >= 0) {
+            DisconnectDatagramSocket(sock);  // don't know what state the old association is in now, so drop it.
+        }
+        return SetSocketErrorBool("Failed to connect datagram socket", err);
+    }
+
+    SDL_assert(addrwithport->ai_addrlen <= sizeof (sock->peer_saddr));
+    SDL_memcpy(&sock->peer_saddr, addrwithport->ai_addr, addrwithport->ai_addrlen);
+    sock->peer_saddrlen = (SockLen) addrwithport->ai_addrlen;
+    freeaddrinfo(addrwithport);
+
+    NET_UnrefAddress(sock->peer_addr);  // okay if NULL.
+    sock->peer_addr = NET_RefAddress(addr);
+    sock->peer_port = port;
+    sock->peer_handle = handle_idx;
+    return true;
+}
+
+static bool ChangeMulticastMembership(NET_DatagramSocket *sock, NET_Address *group, NET_Address *source, NET_Address *iface, bool join)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if (!group) {
+        return SDL_InvalidParamError("group");
+    } else if ((((NET_Status) SDL_GetAtomicInt(&group->status)) != NET_SUCCESS) ||
+               (source && (((NET_Status) SDL_GetAtomicInt(&source->status)) != NET_SUCCESS)) ||
+               (iface && (((NET_Status) SDL_GetAtomicInt(&iface->status)) != NET_SUCCESS))) {
+        return SDL_SetError("Address is not resolved");
+    }
+
+#if defined(SDL_PLATFORM_VITA) || !defined(MCAST_JOIN_GROUP)
+    return SDL_Unsupported();
+#else
+    const struct addrinfo *gai = group->ainfo;
+    const int family = gai->ai_family;
+    if ((source && (source->ainfo->ai_family != family)) || (iface && (iface->ainfo->ai_family != family))) {
+        return SDL_SetError("Multicast addresses must all be the same network family");
+    }
+
+    const NET_DatagramSocketHandle *handle = NULL;
+    for (int i = 0; i < sock->num_handles; i++) {
+        if (sock->handles[i].family == family) {
+            handle = &sock->handles[i];
+            break;
+        }
+    }
+
+    if (!handle) {
+        return SDL_SetError("Unsupported network family in group address");
+    }
+
+    Uint32 interface_index = 0;  // zero lets the system pick an interface.
+    if (iface && !FindInterfaceIndex(iface, &interface_index)) {
+        return false;  // error string was already set.
+    }
+
+    // the protocol-independent MCAST_* options take an interface index instead of an address, and can filter by source.
+    const int level = (family == AF_INET6) ? IPPROTO_IPV6 : IPPROTO_IP;
+    int rc;
+    if (source) {
+        #ifdef MCAST_JOIN_SOURCE_GROUP
+        struct group_source_req req;
+        SDL_zero(req);
+        req.gsr_interface = interface_index;
+        SDL_memcpy(&req.gsr_group, gai->ai_addr, gai->ai_addrlen);
+        SDL_memcpy(&req.gsr_source, source->ainfo->ai_addr, source->ainfo->ai_addrlen);
+        rc = setsockopt(handle->handle, level, join ? MCAST_JOIN_SOURCE_GROUP : MCAST_LEAVE_SOURCE_GROUP, (const char *) &req, (SockLen) sizeof (req));
+        #else
+        return SDL_SetError("Source-specific multicast is not supported on this platform");
+        #endif
+    } else {
+        struct group_req req;
+        SDL_zero(req);
+        req.gr_interface = interface_index;
+        SDL_memcpy(&req.gr_group, gai->ai_addr, gai->ai_addrlen);
+        rc = setsockopt(handle->handle, level, join ? MCAST_JOIN_GROUP : MCAST_LEAVE_GROUP, (const char *) &req, (SockLen) sizeof (req));
+    }
+
+    if (rc == SOCKET_ERROR) {
+        return SetSocketErrorBool(join ? "Failed to join multicast group" : "Failed to leave multicast group", LastSocketError());
+    }
+    return true;
+#endif
+}
+
+bool NET_JoinMulticastGroup(NET_DatagramSocket *sock, NET_Address *group, NET_Address *source, NET_Address *iface)
+{
+    return ChangeMulticastMembership(sock, group, source, iface, true);
+}
+
+bool NET_LeaveMulticastGroup(NET_DatagramSocket *sock, NET_Address *group, NET_Address *source, NET_Address *iface)
+{
+    return ChangeMulticastMembership(sock, group, source, iface, false);
+}
+
+bool NET_GetDatagramSocketBufferSizes(NET_DatagramSocket *sock, int *send_size, int *receive_size)
+{
+    if (send_size) {
+        *send_size = 0;
+    }
+    if (receive_size) {
+        *receive_size = 0;
+    }
+
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    }
+
+    const Socket handle = sock->handles[0].handle;  // every handle was set up with the same sizes.
+    if (send_size) {
+        SockLen len = sizeof (*send_size);
+        if (getsockopt(handle, SOL_SOCKET, SO_SNDBUF, (char *) send_size, &len) == SOCKET_ERROR) {
+            return SetSocketErrorBool("Failed to query SO_SNDBUF", LastSocketError());
+        }
+    }
+    if (receive_size) {
+        SockLen len = sizeof (*receive_size);
+        if (getsockopt(handle, SOL_SOCKET, SO_RCVBUF, (char *) receive_size, &len) == SOCKET_ERROR) {
+            return SetSocketErrorBool("Failed to query SO_RCVBUF", LastSocketError());
+        }
+    }
+    return true;
+}
+
+static bool SetECNBits(Socket handle, int level, int optname, NET_ECN ecn)
+{
+    int value = 0;
+    SockLen len = sizeof (value);
+    if (getsockopt(handle, level, optname, (char *) &value, &len) == SOCKET_ERROR) {
+        value = 0;  // just assume nothing else was set, then.
+    }
+    value = (value & ~0x3) | (int) ecn;  // keep the DSCP bits, if any.
+    if (setsockopt(handle, level, optname, (const char *) &value, sizeof (value)) == SOCKET_ERROR) {
+        return SetSocketErrorBool("Failed to set ECN marking", LastSocketError());
+    }
+    return true;
+}
+
+bool NET_SetDatagramSocketECN(NET_DatagramSocket *sock, NET_ECN ecn)
+{
+    if (!sock) {
+        return SDL_InvalidParamError("sock");
+    } else if (((int) ecn < 0) || ((int) ecn > 3)) {
+        return SDL_InvalidParamError("ecn");
+    }
+
+    for (int i = 0; i < sock->num_handles; i++) {
+        const NET_DatagramSocketHandle *handle = &sock->handles[i];
+        if (handle->family == AF_INET) {
+            if (!SetECNBits(handle->handle, IPPROTO_IP, IP_TOS, ecn)) {
+                return false;
+            }
+        }
+        #ifdef IPV6_TCLASS
+        else if (handle->family == AF_INET6) {
+            if (!SetECNBits(handle->handle, IPPROTO_IPV6, IPV6_TCLASS, ecn)) {
+                return false;
+            }
+        }
+        #endif
+    }
+
+    return true;
+}
+
+Sint64 NET_GetDatagramSocketDroppedPackets(NET_DatagramSocket *sock)
+{
+    if (!sock) {
+        SDL_InvalidParamError("sock");
+        return -1;
+    }
+
+    #ifdef USE_SO_RXQ_OVFL
+    Sint64 total = 0;
+    for (int i = 0; i < sock->num_handles; i++) {
+        total += (Sint64) sock->handles[i].drops;
+    }
+    return total;
+    #else
+    SDL_Unsupported();
+    return -1;
+    #endif
+}
+
+static bool IsDatagramSocketPeer(const NET_DatagramSocket *sock, const NET_Address *addr, Uint16 port)
+{
+    return sock->peer_addr && (port == sock->peer_port) && (NET_CompareAddresses(addr, sock->peer_addr) == 0);
+}
+
+static void SetSockAddrPort(AddressStorage *saddr, Uint16 port)
+{
+    if (((struct sockaddr *) saddr)->sa_family == AF_INET) {
+        ((struct sockaddr_in *) saddr)->sin_port = htons(port);
+    } else if (((struct sockaddr *) saddr)->sa_family == AF_INET6) {
+        ((struct sockaddr_in6 *) saddr)->sin6_port = htons(port);
+    }
+}
+
+static void AddBroadcastTarget(NET_BroadcastTarget *targets, int *num_targets, int handle_idx, const NET_Address *bc)
+{
+    const struct addrinfo *ainfo = bc->ainfo;
+    SDL_assert(ainfo != NULL);
+    SDL_assert(ainfo->ai_addrlen <= sizeof (targets->saddr));
+    NET_BroadcastTarget *target = &targets[(*num_targets)++];
+    target->handle_idx = handle_idx;
+    SDL_memcpy(&target->saddr, ainfo->ai_addr, ainfo->ai_addrlen);
+    target->saddrlen = (SockLen) ainfo->ai_addrlen;
+}
+
+// (re)build the list of addresses a broadcast goes to, so sending doesn't have to walk the interface list every time.
+static bool UpdateBroadcastTargets(NET_DatagramSocket *sock)
+{
+    // the interface list only matters for handles without their own broadcast address (IPv4 bound to INADDR_ANY).
+    bool need_interfaces = false;
+    for (int i = 0; i < sock->num_handles; i++) {
+        if (!sock->handles[i].broadcast) {
+            need_interfaces = true;
+            break;
+        }
+    }
+
+    const bool interfaces_ready = need_interfaces && InterfacesReady();
+    const int generation = SDL_GetAtomicInt(&interfaces_generation);
+    if (sock->broadcast_targets_built && (!need_interfaces || (interfaces_ready && (generation == sock->broadcast_targets_generation)))) {
+        return true;  // still good.
+    }
+
+    if (interfaces_ready) {
+        SDL_LockRWLockForReading(interface_rwlock);
+    }
+
+    const int max_targets = sock->num_handles * (interfaces_ready ? SDL_max(num_interfaces, 1) : 1);
+    NET_BroadcastTarget *targets = (NET_BroadcastTarget *) SDL_malloc(max_targets * sizeof (NET_BroadcastTarget));
+    if (!targets) {
+        if (interfaces_ready) {
+            SDL_UnlockRWLock(interface_rwlock);
+        }
+        return false;
+    }
+
+    int num_targets = 0;
+    for (int i = 0; i < sock->num_handles; i++) {
+        const NET_DatagramSocketHandle *handle = &sock->handles[i];
+        if (handle->broadcast) {
+            AddBroadcastTarget(targets, &num_targets, i, handle->broadcast);
+        } else if (interfaces_ready) {  // iterate all interfaces for this broadcast.
+            for (int j = 0; j < num_interfaces; j++) {
+                const NET_Address *bc = interfaces[j].broadcast;
+                if (bc && (bc->ainfo->ai_family == handle->family)) {
+                    AddBroadcastTarget(targets, &num_targets, i, bc);
+                }
             }
         }
     }
 
-    freeaddrinfo(addrwithport);
-
-    NET_RefAddress(addr);
-    return sock;
-
-failed:
-    for (int i = 0; i < sock->num_handles; i++) {
-        CloseSocketHandle(sock->handles[i].handle);
-        NET_UnrefAddress(sock->handles[i].broadcast);
+    if (interfaces_ready) {
+        SDL_UnlockRWLock(interface_rwlock);
     }
-    freeaddrinfo(addrwithport);
-    SDL_free(allocated_handles);
-    SDL_free(sock);
-    return NULL;
+
+    SDL_free(sock->broadcast_targets);
+    sock->broadcast_targets = targets;
+    sock->num_broadcast_targets = num_targets;
+    sock->broadcast_targets_generation = interfaces_ready ? generation : -1;
+    sock->broadcast_targets_built = true;
+    return true;
 }
 
 static NET_Status SendOneDatagram(NET_DatagramSocket *sock, NET_Address *addr, Uint16 port, const void *buf, int buflen)
 {
-    if (addr) {  // unicast to a specific address.
+    if (addr && IsDatagramSocketPeer(sock, addr, port)) {  // connected to this peer, so the system already knows where this goes.
+        SDL_assert(sock->peer_handle >= 0);
+        // WinSock's send wants a `const char *` buffer instead of `const void *`. The cast here is harmless on BSD Sockets.
+        const int rc = (int) send(sock->handles[sock->peer_handle].handle, (const char *) buf, (size_t) buflen, 0);
+        if (rc == SOCKET_ERROR) {
+            const int err = LastSocketError();
+            return WouldBlock(err) ? NET_WAITING : SetSocketError("Failed to send from socket", err);
+        }
+        SDL_assert(rc == buflen);
+        return NET_SUCCESS;
+    } else if (addr) {  // unicast to a specific address.
         struct addrinfo *addrwithport = MakeAddrInfoWithPort(addr, SOCK_DGRAM, port);
         if (!addrwithport) {
             return NET_FAILURE;
@@ -2333,58 +4767,80 @@ static NET_Status SendOneDatagram(NET_DatagramSocket *sock, NET_Address *addr, U
     // broadcast (or fake with multicast) this packet.
     SDL_assert(sock->allow_broadcast);  // we should have checked this in NET_SendDatagram!
 
-    bool all_wouldblock = false;
-    NET_Status retval = NET_FAILURE;
-    for (int i = 0; i < sock->num_handles; i++) {
-        const NET_DatagramSocketHandle *handle = &sock->handles[i];
+    if (!UpdateBroadcastTargets(sock)) {
+        return NET_FAILURE;  // error string was already set.
+    } else if (sock->num_broadcast_targets == 0) {
+        SDL_SetError("No network interfaces available to broadcast on");
+        return NET_FAILURE;
+    }
 
-        if (handle->broadcast) {
-            struct addrinfo *addrwithport = MakeAddrInfoWithPort(handle->broadcast, SOCK_DGRAM, port);
-            if (!addrwithport) {
-                continue;  // oh well, lost UDP packet, I guess.
-            }
+    bool all_wouldblock = true;
+    NET_Status retval = NET_FAILURE;
+    NET_BroadcastTarget *targets = sock->broadcast_targets;
+    const int num_targets = sock->num_broadcast_targets;
+    for (int i = 0; i < num_targets; i++) {
+        SetSockAddrPort(&targets[i].saddr, port);
+    }
+
+    // targets are grouped by handle, so each group can go out in one system call where that's supported.
+    int i = 0;
+    while (i < num_targets) {
+        const int handle_idx = targets[i].handle_idx;
+        int end = i + 1;
+        while ((end < num_targets) && (targets[end].handle_idx == handle_idx)) {
+            end++;
+        }
 
-            //SDL_Log("Broadcasting on %s ...", handle->broadcast->human_readable);
-            const int rc = (int) sendto(handle->handle, buf, (size_t) buflen, 0, addrwithport->ai_addr, (SockLen) addrwithport->ai_addrlen);
-            const int err = (rc == SOCKET_ERROR) ? LastSocketError() : 0;
-            freeaddrinfo(addrwithport);
-            if (!err) {
-                retval = NET_SUCCESS;  // it went to at least one interface's broadcast address, we'll call it success.
-            } else {
-                if (!WouldBlock(err)) {
-                    all_wouldblock = false;
-                    SetSocketError("Failed to send from socket", err);  // so there's a clear error message, but keep going, maybe something else works out.
-                }
+        const Socket handle = sock->handles[handle_idx].handle;
+
+        #ifdef USE_SENDMMSG
+        struct iovec iov;
+        iov.iov_base = (void *) buf;
+        iov.iov_len = (size_t) buflen;
+
+        struct mmsghdr msgs[16];
+        while (i < end) {
+            const int total = SDL_min(end - i, (int) SDL_arraysize(msgs));
+            SDL_memset(msgs, '\0', sizeof (*msgs) * total);
+            for (int j = 0; j < total; j++) {
+                msgs[j].msg_hdr.msg_name = &targets[i + j].saddr;
+                msgs[j].msg_hdr.msg_namelen = targets[i + j].saddrlen;
+                msgs[j].msg_hdr.msg_iov = &iov;
+                msgs[j].msg_hdr.msg_iovlen = 1;
             }
-        } else if (!addr && InterfacesReady()) {  // iterate all interfaces for this broadcast.
-            SDL_LockRWLockForReading(interface_rwlock);
-            for (int i = 0; i < num_interfaces; i++) {
-                const NET_Address *bc = interfaces[i].broadcast;
-                if (!bc) { continue; }
-                const struct addrinfo *ainfo = bc->ainfo;
-                SDL_assert(ainfo != NULL);
-                if (ainfo->ai_family != handle->family) { continue; }
-
-                struct addrinfo *addrwithport = MakeAddrInfoWithPort(bc, SOCK_DGRAM, port);
-                if (!addrwithport) {
-                    continue;  // oh well, lost UDP packet, I guess.
-                }
 
-                //SDL_Log("Broadcasting on %s ...", bc->human_readable);
-                const int rc = (int) sendto(handle->handle, buf, (size_t) buflen, 0, addrwithport->ai_addr, (SockLen) addrwithport->ai_addrlen);
-                const int err = (rc == SOCKET_ERROR) ? LastSocketError() : 0;
-                freeaddrinfo(addrwithport);
-                if (!err) {
+            int done = 0;
+            while (done < total) {
+                const int rc = sendmmsg(handle, msgs + done, (unsigned int) (total - done), 0);
+                if (rc > 0) {
                     retval = NET_SUCCESS;  // it went to at least one interface's broadcast address, we'll call it success.
+                    done += rc;
                 } else {
+                    const int err = (rc < 0) ? LastSocketError() : 0;
                     if (!WouldBlock(err)) {
                         all_wouldblock = false;
                         SetSocketError("Failed to send from socket", err);  // so there's a clear error message, but keep going, maybe something else works out.
                     }
+                    done++;  // skip the one that failed and try the rest.
                 }
             }
-            SDL_UnlockRWLock(interface_rwlock);
+            i += total;
         }
+        #else
+        for (; i < end; i++) {
+            //SDL_Log("Broadcasting on target %d ...", i);
+            const int rc = (int) sendto(handle, buf, (size_t) buflen, 0, (const struct sockaddr *) &targets[i].saddr, targets[i].saddrlen);
+            if (rc != SOCKET_ERROR) {
+                retval = NET_SUCCESS;  // it went to at least one interface's broadcast address, we'll call it success.
+            } else {
+                const int err = LastSocketError();
+                if (!WouldBlock(err)) {
+                    all_wouldblock = false;
+                    SetSocketError("Failed to send from socket", err);  // so there's a clear error message, but keep going, maybe something else works out.
+                }
+            }
+        }
+        #endif
     }
 
     if ((retval == NET_FAILURE) && all_wouldblock) {
@@ -2479,12 +4935,305 @@ bool NET_SendDatagram(NET_DatagramSocket *sock, NET_Address *addr, Uint16 port,
     dgram->addr = NET_RefAddress(addr);
     dgram->port = port;
     dgram->buflen = buflen;
+    dgram->timestamp = 0;
+    dgram->ecn = NET_ECN_NOT_ECT;
 
     sock->pending_output[sock->pending_output_len++] = dgram;
 
     return true;
 }
 
+#define MAX_UDP_SEGMENT_SEND 65507  // the whole send still has to fit in a single (IPv4) UDP datagram before it gets split.
+
+#ifdef USE_UDP_SEGMENT
+#define MAX_UDP_SEGMENTS 64  // the kernel's UDP_MAX_SEGMENTS; it refuses to split a send into more than this.
+
+// hand the kernel big runs of equal-sized datagrams in a single sendmsg() call, and let it (or the network device) split
+//  them up. Returns number of bytes sent (which might be less than buflen, if it would block or the kernel can't
+//  do this), or -1 on fatal error.
+static int SendDatagramSegmentsOffloaded(NET_DatagramSocket *sock, NET_Address *addr, Uint16 port, const Uint8 *buf, int buflen, int segment_size)
+{
+    struct addrinfo *addrwithport = MakeAddrInfoWithPort(addr, SOCK_DGRAM, port);
+    if (!addrwithport) {
+        return -1;
+    }
+
+    const NET_DatagramSocketHandle *handle = NULL;
+    for (int i = 0; i < sock->num_handles; i++) {
+        if ((sock->handles[i].family == addrwithport->ai_family) && (sock->handles[i].protocol == addrwithport->ai_protocol)) {
+            handle = &sock->handles[i];
+            break;
+        }
+    }
+
+    if (!handle) {
+        freeaddrinfo(addrwithport);
+        SDL_SetError("Unsupported network family in destination address");
+        return -1;
+    }
+
+    const int max_send = SDL_min(MAX_UDP_SEGMENTS, MAX_UDP_SEGMENT_SEND / segment_size) * segment_size;
+    int sent = 0;
+    while ((max_send > segment_size) && ((buflen - sent) > segment_size)) {  // only worth it if at least two segments fit in one send.  // a lone (or short) final segment just goes out the usual way.
+        const int len = SDL_min(buflen - sent, max_send);
+
+        struct iovec iov;
+        iov.iov_base = (void *) (buf + sent);
+        iov.iov_len = (size_t) len;
+
+        union { char buf[CMSG_SPACE(sizeof (Uint16))]; struct cmsghdr align; } control;
+        SDL_zero(control);
+
+        struct msghdr msg;
+        SDL_zero(msg);
+        msg.msg_name = addrwithport->ai_addr;
+        msg.msg_namelen = (SockLen) addrwithport->ai_addrlen;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof (control.buf);
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof (Uint16));
+        const Uint16 gso_size = (Uint16) segment_size;
+        SDL_memcpy(CMSG_DATA(cmsg), &gso_size, sizeof (gso_size));
+
+        if (sendmsg(handle->handle, &msg, 0) == SOCKET_ERROR) {
+            const int err = LastSocketError();
+            if (WouldBlock(err)) {
+                break;  // let the caller queue the rest.
+            } else if ((err == ENOPROTOOPT) || (err == EOPNOTSUPP) || (err == EIO)) {
+                sock->udp_segment_unsupported = true;  // old kernel, or a device that can't checksum for us. Don't try again.
+                break;
+            } else if (err == EINVAL) {
+                break;  // probably a segment bigger than the path MTU; this isn't fatal, just send these the usual way.
+            }
+            freeaddrinfo(addrwithport);
+            return SetSocketError("Failed to send from socket", err);
+        }
+
+        sent += len;
+    }
+
+    freeaddrinfo(addrwithport);
+    return sent;
+}
+#endif
+
+bool NET_SendDatagramSegments(NET_DatagramSocket *sock, NET_Address *addr, Uint16 port, const void *buf, int buflen, int segment_size)
+{
+    if (!PumpDatagramSocket(sock)) {  // try to flush any queued data to the socket now, before we handle more.
+        return false;
+    } else if (!addr && !sock->allow_broadcast) {
+        return SDL_SetError("Datagram socket was not created with broadcast support");
+    } else if (buf == NULL) {
+        return SDL_InvalidParamError("buf");
+    } else if (buflen < 0) {
+        return SDL_InvalidParamError("buflen");
+    } else if ((segment_size <= 0) || (segment_size > MAX_UDP_SEGMENT_SEND)) {
+        return SDL_InvalidParamError("segment_size");
+    }
+
+    const Uint8 *ptr = (const Uint8 *) buf;
+    int sent = 0;
+
+    #ifdef USE_UDP_SEGMENT
+    // simulated packet loss has to decide per-packet, and anything already queued has to go out first, so those take the slow path.
+    if (addr && (sock->percent_loss == 0) && (sock->pending_output_len == 0) && !sock->udp_segment_unsupported) {
+        sent = SendDatagramSegmentsOffloaded(sock, addr, port, ptr, buflen, segment_size);
+        if (sent < 0) {
+            return false;  // error string was already set.
+        }
+    }
+    #endif
+
+    // whatever is left goes out one datagram per segment, queueing as necessary.
+    while (sent < buflen) {
+        const int len = SDL_min(buflen - sent, segment_size);
+        if (!NET_SendDatagram(sock, addr, port, ptr + sent, len)) {
+            return false;
+        }
+        sent += len;
+    }
+
+    return true;
+}
+
+
+// extra details the system can report about a received packet, through recvmsg() control messages.
+typedef struct NET_DatagramRecvInfo
+{
+    int segment_size;  // nonzero if the system merged several packets from the same sender (UDP_GRO), and this is the size of each.
+    SDL_Time timestamp;  // when the packet reached this machine, or zero if the system didn't say.
+    bool has_drops;
+    Uint32 drops;  // total packets the system dropped on this handle because the receive buffer was full.
+    NET_ECN ecn;  // the low two bits of the packet's IPv4 TOS or IPv6 traffic class.
+} NET_DatagramRecvInfo;
+
+// read one packet into sock->recv_buffer.
+static int ReceiveIntoDatagramBuffer(NET_DatagramSocket *sock, Socket handle, AddressStorage *from, SockLen *fromlen, NET_DatagramRecvInfo *info)
+{
+    SDL_zerop(info);
+
+    #ifdef USE_RECVMSG
+    struct iovec iov;
+    iov.iov_base = sock->recv_buffer;
+    iov.iov_len = sizeof (sock->recv_buffer);
+
+    union { char buf[CMSG_SPACE(sizeof (int)) + CMSG_SPACE(sizeof (struct timespec)) + CMSG_SPACE(sizeof (Uint32)) + CMSG_SPACE(sizeof (int))]; struct cmsghdr align; } control;
+
+    struct msghdr msg;
+    SDL_zero(msg);
+    msg.msg_name = from;
+    msg.msg_namelen = *fromlen;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof (control.buf);
+
+    const int br = (int) recvmsg(handle, &msg, 0);
+    if (br != SOCKET_ERROR) {
+        *fromlen = msg.msg_namelen;
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            #ifdef USE_UDP_GRO
+            if ((cmsg->cmsg_level == SOL_UDP) && (cmsg->cmsg_type == UDP_GRO)) {
+                int gso_size = 0;
+                SDL_memcpy(&gso_size, CMSG_DATA(cmsg), sizeof (gso_size));
+                if ((gso_size > 0) && (gso_size < br)) {
+                    info->segment_size = gso_size;
+                }
+            }
+            #endif
+            #ifdef USE_SO_TIMESTAMPNS
+            if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS)) {
+                struct timespec ts;
+                SDL_memcpy(&ts, CMSG_DATA(cmsg), sizeof (ts));
+                info->timestamp = SDL_SECONDS_TO_NS((SDL_Time) ts.tv_sec) + (SDL_Time) ts.tv_nsec;  // CLOCK_REALTIME, same as SDL_GetCurrentTime().
+            }
+            #endif
+            #ifdef USE_SO_RXQ_OVFL
+            if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SO_RXQ_OVFL)) {  // only sent once something has actually been dropped.
+                SDL_memcpy(&info->drops, CMSG_DATA(cmsg), sizeof (info->drops));
+                info->has_drops = true;
+            }
+            #endif
+            if ((cmsg->cmsg_level == IPPROTO_IP) && (cmsg->cmsg_type == IP_TOS)) {  // IPv4 reports a single byte...
+                Uint8 tos = 0;
+                SDL_memcpy(&tos, CMSG_DATA(cmsg), sizeof (tos));
+                info->ecn = (NET_ECN) (tos & 0x3);
+            } else if ((cmsg->cmsg_level == IPPROTO_IPV6) && (cmsg->cmsg_type == IPV6_TCLASS)) {  // ...but IPv6 reports an int.
+                int tclass = 0;
+                SDL_memcpy(&tclass, CMSG_DATA(cmsg), sizeof (tclass));
+                info->ecn = (NET_ECN) (tclass & 0x3);
+            }
+        }
+    }
+    return br;
+    #else
+    // WinSock's recvfrom wants a `char *` buffer instead of `void *`. The cast here is harmless on BSD Sockets.
+    return (int) recvfrom(handle, (char *) sock->recv_buffer, sizeof (sock->recv_buffer), 0, (struct sockaddr *) from, fromlen);
+    #endif
+}
+
+// hand out the next piece of a merged packet that's still sitting in recv_buffer. *dgram stays NULL if there aren't any.
+static bool ReceiveCoalescedDatagram(NET_DatagramSocket *sock, NET_Datagram **dgram)
+{
+    while (sock->coalesced_addr) {
+        NET_Address *addr = sock->coalesced_addr;
+        const int offset = sock->coalesced_offset;
+        const int len = SDL_min(sock->coalesced_segment_size, sock->coalesced_len - offset);
+        sock->coalesced_offset += len;
+
+        const bool last = (sock->coalesced_offset >= sock->coalesced_len);
+        if (last) {
+            sock->coalesced_addr = NULL;  // we take over this reference below.
+        }
+
+        if (ShouldSimulateLoss(sock->percent_loss)) {
+            // you won the percent_loss lottery. Drop this packet as if it never arrived.
+            if (last) {
+                NET_UnrefAddress(addr);
+            }
+            continue;
+        }
+
+        NET_Datagram *dg = SDL_malloc(sizeof (NET_Datagram) + len);
+        if (!dg) {
+            if (last) {
+                NET_UnrefAddress(addr);
+            }
+            return false;
+        }
+
+        dg->buf = (Uint8 *) (dg+1);
+        SDL_memcpy(dg->buf, sock->recv_buffer + offset, len);
+        dg->addr = last ? addr : NET_RefAddress(addr);
+        dg->port = sock->coalesced_port;
+        dg->buflen = len;
+        dg->timestamp = sock->coalesced_timestamp;
+        dg->ecn = sock->coalesced_ecn;
+
+        *dgram = dg;
+        break;
+    }
+
+    return true;
+}
+
+// find (or create) the NET_Address for a received packet's sender. Returns a new reference, or NULL on error.
+static NET_Address *GetDatagramSenderAddress(NET_DatagramSocket *sock, int handle_idx, const AddressStorage *from, SockLen fromlen, Uint16 *port)
+{
+    // a connected socket should only get packets from its peer, but some might have been queued before it connected.
+    if ((handle_idx == sock->peer_handle) && (fromlen == sock->peer_saddrlen) && (SDL_memcmp(from, &sock->peer_saddr, (size_t) fromlen) == 0)) {
+        *port = sock->peer_port;
+        return NET_RefAddress(sock->peer_addr);
+    }
+
+    char hostbuf[128];
+    char portbuf[16];
+    const int rc = getnameinfo((const struct sockaddr *) from, fromlen, hostbuf, sizeof (hostbuf), portbuf, sizeof (portbuf), NI_NUMERICHOST | NI_NUMERICSERV);
+    if (rc != 0) {
+        SetGetAddrInfoError("Failed to determine incoming packet's address", rc);
+        return NULL;
+    }
+
+    *port = (Uint16) SDL_atoi(portbuf);
+
+    // Cache the last X addresses we saw; if we see it again, refcount it and reuse it.
+    for (int i = sock->latest_recv_addrs_idx - 1; i >= 0; i--) {
+        SDL_assert(sock->latest_recv_addrs != NULL);
+        NET_Address *a = sock->latest_recv_addrs[i];
+        SDL_assert(a != NULL);  // can't be NULL, we either set this before or wrapped around to set again, but it can't be NULL.
+        if (SDL_strcmp(a->human_readable, hostbuf) == 0) {
+            return NET_RefAddress(a);
+        }
+    }
+
+    const int idx = sock->latest_recv_addrs_idx;
+    for (int i = (int) SDL_arraysize(sock->latest_recv_addrs) - 1; i >= idx; i--) {
+        NET_Address *a = sock->latest_recv_addrs[i];
+        if (a == NULL) {
+            break;  // ran out of already-seen entries.
+        }
+        if (SDL_strcmp(a->human_readable, hostbuf) == 0) {
+            return NET_RefAddress(a);
+        }
+    }
+
+    NET_Address *fromaddr = CreateSDLNetAddrFromSockAddr((const struct sockaddr *) from, fromlen);
+    if (!fromaddr) {
+        return NULL;  // already set the error string.
+    }
+
+    // keep track of the last X addresses we saw.
+    NET_UnrefAddress(sock->latest_recv_addrs[sock->latest_recv_addrs_idx]);  // okay if "oldest" address slot is still NULL.
+    sock->latest_recv_addrs[sock->latest_recv_addrs_idx++] = NET_RefAddress(fromaddr);
+    sock->latest_recv_addrs_idx %= SDL_arraysize(sock->latest_recv_addrs);
+
+    return fromaddr;
+}
 
 bool NET_ReceiveDatagram(NET_DatagramSocket *sock, NET_Datagram **dgram)
 {
@@ -2496,91 +5245,82 @@ bool NET_ReceiveDatagram(NET_DatagramSocket *sock, NET_Datagram **dgram)
 
     if (!PumpDatagramSocket(sock)) {  // try to flush any queued data to the socket now, before we go further.
         return false;
+    } else if (!ReceiveCoalescedDatagram(sock, dgram)) {  // still working through a merged packet from last time?
+        return false;
+    } else if (*dgram) {
+        return true;
     }
 
+    bool drained = true;
     for (int i = 0; i < sock->num_handles; i++) {
         AddressStorage from;
         SockLen fromlen = sizeof (from);
-        // WinSock's recvfrom wants a `char *` buffer instead of `void *`. The cast here is harmless on BSD Sockets.
-        const int br = (int) recvfrom(sock->handles[i].handle, (char *) sock->recv_buffer, sizeof (sock->recv_buffer), 0, (struct sockaddr *) &from, &fromlen);
+        NET_DatagramRecvInfo info;
+        const int br = ReceiveIntoDatagramBuffer(sock, sock->handles[i].handle, &from, &fromlen, &info);
         if (br == SOCKET_ERROR) {
             const int err = LastSocketError();
             if (WouldBlock(err)) {
                 continue;
             }
             return SetSocketErrorBool("Failed to receive datagrams", err);
-        } else if (ShouldSimulateLoss(sock->percent_loss)) {
-            // you won the percent_loss lottery. Drop this packet as if it never arrived.
-            continue;
         }
 
-        char hostbuf[128];
-        char portbuf[16];
-        const int rc = getnameinfo((struct sockaddr *) &from, fromlen, hostbuf, sizeof (hostbuf), portbuf, sizeof (portbuf), NI_NUMERICHOST | NI_NUMERICSERV);
-        if (rc != 0) {
-            return SetGetAddrInfoErrorBool("Failed to determine incoming packet's address", rc);
-        }
-
-        // Cache the last X addresses we saw; if we see it again, refcount it and reuse it.
-        NET_Address *fromaddr = NULL;
-        for (int i = sock->latest_recv_addrs_idx - 1; i >= 0; i--) {
-            SDL_assert(sock->latest_recv_addrs != NULL);
-            NET_Address *a = sock->latest_recv_addrs[i];
-            SDL_assert(a != NULL);  // can't be NULL, we either set this before or wrapped around to set again, but it can't be NULL.
-            if (SDL_strcmp(a->human_readable, hostbuf) == 0) {
-                fromaddr = a;
-                break;
-            }
+        if (info.has_drops) {
+            sock->handles[i].drops = info.drops;
         }
 
+        if ((info.segment_size == 0) && ShouldSimulateLoss(sock->percent_loss)) {  // merged packets decide this per-segment, later.
+            // you won the percent_loss lottery. Drop this packet as if it never arrived.
+            drained = false;  // there might be more waiting behind it, though.
+            continue;
+        }
+
+        Uint16 fromport = 0;
+        NET_Address *fromaddr = GetDatagramSenderAddress(sock, i, &from, fromlen, &fromport);
         if (!fromaddr) {
-            const int idx = sock->latest_recv_addrs_idx;
-            for (int i = (int) SDL_arraysize(sock->latest_recv_addrs) - 1; i >= idx; i--) {
-                NET_Address *a = sock->latest_recv_addrs[i];
-                if (a == NULL) {
-                    break;  // ran out of already-seen entries.
-                }
-                if (SDL_strcmp(a->human_readable, hostbuf) == 0) {
-                    fromaddr = a;
-                    break;
-                }
-            }
+            return false;  // already set the error string.
         }
 
-        const bool create_fromaddr = (!fromaddr) ? true : false;
-        if (create_fromaddr) {
-            fromaddr = CreateSDLNetAddrFromSockAddr((struct sockaddr *) &from, fromlen);
-            if (!fromaddr) {
-                return false;  // already set the error string.
+        if (info.segment_size > 0) {  // several packets merged into one buffer; hand them out one at a time.
+            sock->coalesced_addr = fromaddr;
+            sock->coalesced_port = fromport;
+            sock->coalesced_len = br;
+            sock->coalesced_offset = 0;
+            sock->coalesced_segment_size = info.segment_size;
+            sock->coalesced_timestamp = info.timestamp;
+            sock->coalesced_ecn = info.ecn;  // the system only merges packets with the same marking.
+
+            if (!ReceiveCoalescedDatagram(sock, dgram)) {
+                return false;
+            } else if (*dgram) {
+                return true;  // we got one!
             }
+            drained = false;  // simulated loss dropped every one of them, but there might be more waiting behind them.
+            continue;
         }
 
         NET_Datagram *dg = SDL_malloc(sizeof (NET_Datagram) + br);
         if (!dg) {
-            if (create_fromaddr) {
-                NET_UnrefAddress(fromaddr);
-            }
+            NET_UnrefAddress(fromaddr);
             return false;
         }
 
         dg->buf = (Uint8 *) (dg+1);
         SDL_memcpy(dg->buf, sock->recv_buffer, br);
-        dg->addr = create_fromaddr ? fromaddr : NET_RefAddress(fromaddr);
-        dg->port = (Uint16) SDL_atoi(portbuf);
+        dg->addr = fromaddr;
+        dg->port = fromport;
         dg->buflen = br;
+        dg->timestamp = info.timestamp;
+        dg->ecn = info.ecn;
 
         *dgram = dg;
 
-        if (create_fromaddr) {
-            // keep track of the last X addresses we saw.
-            NET_UnrefAddress(sock->latest_recv_addrs[sock->latest_recv_addrs_idx]);  // okay if "oldest" address slot is still NULL.
-            sock->latest_recv_addrs[sock->latest_recv_addrs_idx++] = NET_RefAddress(fromaddr);
-            sock->latest_recv_addrs_idx %= SDL_arraysize(sock->latest_recv_addrs);
-        }
-
         return true;  // we got one!
     }
 
+    if (drained) {
+        sock->input_needs_drain = false;  // every handle would block, so we've drained all pending packets.
+    }
     return true;  // nothing new.
 }
 
@@ -2612,6 +5352,9 @@ void NET_DestroyDatagramSocket(NET_DatagramSocket *sock)
         for (int i = 0; i < ((int) SDL_arraysize(sock->latest_recv_addrs)); i++) {
             NET_UnrefAddress(sock->latest_recv_addrs[i]);
         }
+        NET_UnrefAddress(sock->coalesced_addr);
+        NET_UnrefAddress(sock->peer_addr);
+        SDL_free(sock->broadcast_targets);
         for (int i = 0; i < sock->pending_output_len; i++) {
             NET_DestroyDatagram(sock->pending_output[i]);
         }
@@ -2633,7 +5376,8 @@ typedef union NET_GenericSocket
 } NET_GenericSocket;
 
 
-int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
+// if edge_triggered, sockets that were already reported aren't reported again until the app drains them.
+static int WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms, bool edge_triggered)
 {
     NET_GenericSocket **sockets = (NET_GenericSocket **) vsockets;
     if (!sockets) {
@@ -2659,7 +5403,11 @@ int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
         }
         switch (sock->socktype) {
             case SOCKETTYPE_STREAM:
-                numhandles++;
+                if (sock->stream.race) {
+                    numhandles += sock->stream.race->num_candidates;  // a connection race might have an attempt in flight for every address.
+                } else {
+                    numhandles += sock->stream.threadsafe_writes ? 2 : 1;  // thread-safe writes need the wakeup socket polled, too.
+                }
                 break;
             case SOCKETTYPE_DATAGRAM:
                 numhandles += sock->dgram.num_handles;
@@ -2685,45 +5433,100 @@ int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
         struct pollfd *pfd = &pfds[0];
         SDL_memset(pfds, '\0', sizeof (*pfds) * numhandles);
 
+        // sockets only poll for writability when they have pending output they can actually send, and we only write one
+        //  bounded batch per wakeup, so we don't spin on sockets that are always writable. Sockets that are holding
+        //  output back to simulate lag will shorten the poll instead, so we can resume sending when the lag is over.
+        const Uint64 pollstart = SDL_GetTicks();
+        int polltimeout = timeoutms;
+
         for (int i = 0; i < numsockets; i++) {
-            const NET_GenericSocket *sock = sockets[i];
+            NET_GenericSocket *sock = sockets[i];
 
             switch (sock->socktype) {
-                case SOCKETTYPE_STREAM:
+                case SOCKETTYPE_STREAM: {
+                    if (sock->stream.race) {
+                        const NET_ConnectRace *race = sock->stream.race;
+                        for (int j = 0; j < race->num_candidates; j++, pfd++) {
+                            pfd->fd = (j < race->num_attempts) ? race->attempts[j] : INVALID_SOCKET;
+                            pfd->events = POLLOUT;  // marked as writable when connection is complete.
+                        }
+                        if (race->next_candidate < race->num_candidates) {  // wake up in time to start the next attempt.
+                            const int nextms = (race->next_attempt_ticks > pollstart) ? (int) SDL_min(race->next_attempt_ticks - pollstart, (Uint64) SDL_MAX_SINT32) : 0;
+                            polltimeout = (polltimeout < 0) ? nextms : SDL_min(polltimeout, nextms);
+                        }
+                        break;
+                    }
+
+                    if (sock->stream.threadsafe_writes) {
+                        SDL_SetAtomicInt(&sock->stream.wake_needed, 1);  // before we check for pending output, so a write that lands after the check wakes us.
+                    }
+
+                    const bool want_input = !(edge_triggered && sock->stream.input_needs_drain);
+                    const Uint64 lag = (!sock->stream.threadsafe_writes && StreamSocketHasPendingOutput(&sock->stream)) ? StreamSocketSimulatedLagRemaining(&sock->stream, pollstart) : 0;
+                    if (lag > 0) {
+                        const int lagms = (int) SDL_min(lag, (Uint64) SDL_MAX_SINT32);
+                        polltimeout = (polltimeout < 0) ? lagms : SDL_min(polltimeout, lagms);
+                    }
+
+                    if (StreamSocketHasBufferedInput(&sock->stream, edge_triggered)) {
+                        polltimeout = 0;  // we already read ahead data the app hasn't looked at, so don't sleep.
+                    }
+
                     pfd->fd = sock->stream.handle;
                     if (sock->stream.status == NET_WAITING) {
                         pfd->events = POLLOUT;  // marked as writable when connection is complete.
-                    } else if (sock->stream.pending_output_len > 0) {
-                        pfd->events = POLLIN|POLLOUT;  // poll for input or when we can write more of the pending buffer.
-                    } else {
+                    } else if (StreamSocketWantsWrite(&sock->stream, pollstart)) {
+                        pfd->events = want_input ? (POLLIN|POLLOUT) : POLLOUT;  // poll for input or when we can write more of the pending buffer.
+                    } else if (want_input) {
                         pfd->events = POLLIN;  // poll for input or when we can write more of the pending buffer.
+                    } else {
+                        pfd->fd = INVALID_SOCKET;  // nothing to wait for here; poll() will ignore this entry.
+                    }
+
+                    if (sock->stream.threadsafe_writes) {
+                        if (pfd->events & POLLOUT) {
+                            SDL_SetAtomicInt(&sock->stream.wake_needed, 0);  // already watching for writability, so writers don't need to wake us.
+                        }
+                        pfd++;
+                        pfd->fd = sock->stream.wake_handle;
+                        pfd->events = POLLIN;
                     }
                     pfd++;
                     break;
+                }
 
-                case SOCKETTYPE_DATAGRAM:
+                case SOCKETTYPE_DATAGRAM: {
+                    const bool want_input = !(edge_triggered && sock->dgram.input_needs_drain);
+                    if (want_input && sock->dgram.coalesced_addr) {
+                        polltimeout = 0;  // we already received packets the app hasn't looked at, so don't sleep.
+                    }
                     for (int j = 0; j < sock->dgram.num_handles; j++) {
                         pfd->fd = sock->dgram.handles[j].handle;
                         if (sock->dgram.pending_output_len > 0) {
-                            pfd->events = POLLIN|POLLOUT;  // poll for input or when we can write more of the pending buffer.
-                        } else {
+                            pfd->events = want_input ? (POLLIN|POLLOUT) : POLLOUT;  // poll for input or when we can write more of the pending buffer.
+                        } else if (want_input) {
                             pfd->events = POLLIN;  // poll for input or when we can write more of the pending buffer.
+                        } else {
+                            pfd->fd = INVALID_SOCKET;  // nothing to wait for here; poll() will ignore this entry.
                         }
                         pfd++;
                     }
                     break;
+                }
 
-                case SOCKETTYPE_SERVER:
+                case SOCKETTYPE_SERVER: {
+                    const bool want_input = !(edge_triggered && sock->server.input_needs_drain);
                     for (int j = 0; j < sock->server.num_handles; j++) {
-                        pfd->fd = sock->server.handles[j];
+                        pfd->fd = want_input ? sock->server.handles[j] : INVALID_SOCKET;
                         pfd->events = POLLIN;  // poll for new connections.
                         pfd++;
                     }
                     break;
+                }
             }
         }
 
-        const int rc = poll(pfds, numhandles, timeoutms);
+        const int rc = poll(pfds, (int) (pfd - pfds), polltimeout);  // a connection race might have finished since we counted handles, so this can be less than numhandles.
 
         if (rc == SOCKET_ERROR) {
             SDL_free(malloced_pfds);
@@ -2738,13 +5541,50 @@ int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
 
             switch (sock->socktype) {
                 case SOCKETTYPE_STREAM: {
-                    SDL_assert(pfd->fd == sock->stream.handle);
-                    const bool failed = ((pfd->revents & (POLLERR|POLLHUP|POLLNVAL)) != 0) ? true : false;
+                    if (sock->stream.race) {
+                        const int entries = sock->stream.race->num_candidates;
+                        count_it = UpdateConnectRace(&sock->stream, pfd, SDL_GetTicks());  // report the socket once the race is won or lost.
+                        pfd += entries;
+                        break;
+                    }
+
+                    if (sock->stream.threadsafe_writes) {
+                        SDL_SetAtomicInt(&sock->stream.wake_needed, 0);  // we're out of poll(), so anything queued from here on gets noticed below or next time.
+                    }
+
+                    SDL_assert((pfd->fd == sock->stream.handle) || (pfd->fd == INVALID_SOCKET));
+                    bool failed = ((pfd->revents & (POLLERR|POLLHUP|POLLNVAL)) != 0) ? true : false;
                     const bool writable = (pfd->revents & POLLOUT) ? true : false;
                     const bool readable = (pfd->revents & POLLIN) ? true : false;
 
+                    #ifdef USE_ZEROCOPY
+                    // MSG_ZEROCOPY completions arrive as POLLERR. Collect them, and report the socket so the app can
+                    //  reuse those buffers, but it's only a failure if that wasn't what woke us up.
+                    if (failed && (sock->stream.zerocopy_state > 0) && !(pfd->revents & (POLLHUP|POLLNVAL))) {
+                        if (!sock->stream.threadsafe_writes) {
+                            count_it = ReadZeroCopyCompletions(&sock->stream);
+                        } else if (SDL_TryLockSpinlock(&sock->stream.pump_lock)) {
+                            count_it = ReadZeroCopyCompletions(&sock->stream);
+                            SDL_UnlockSpinlock(&sock->stream.pump_lock);
+                        } else {
+                            count_it = true;  // someone else is busy with the socket; the app can ask for completions itself.
+                        }
+                        failed = !count_it;
+                    }
+                    #endif
+
                     if (readable || failed) {
                         count_it = true;
+                        if (edge_triggered) {
+                            sock->stream.input_needs_drain = true;
+                        }
+                    }
+
+                    if (StreamSocketHasBufferedInput(&sock->stream, edge_triggered)) {
+                        count_it = true;
+                        if (edge_triggered) {
+                            sock->stream.input_buffer_reported = true;
+                        }
                     }
 
                     if (sock->stream.status == NET_WAITING) {
@@ -2757,8 +5597,24 @@ int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
                             sock->stream.status = NET_SUCCESS;
                             count_it = true;
                         }
-                    } else if (writable) {
-                        PumpStreamSocket(&sock->stream);
+                    } else if (GetStreamSocketPendingOutputLen(&sock->stream) > 0) {
+                        // pump if the socket is writable, or if we didn't poll for writability because of simulated lag that has now passed.
+                        const bool lag_over = !(pfd->events & POLLOUT) && (StreamSocketSimulatedLagRemaining(&sock->stream, SDL_GetTicks()) == 0);
+                        if (writable || lag_over) {
+                            if (!PumpStreamSocket(&sock->stream)) {
+                                count_it = true;  // socket failed; return so the app can find out about it.
+                            } else if (GetStreamSocketPendingOutputLen(&sock->stream) == 0) {
+                                count_it = true;  // finished draining pending output; return so the app can queue more.
+                            }
+                        }
+                    }
+
+                    if (sock->stream.threadsafe_writes) {
+                        pfd++;
+                        SDL_assert(pfd->fd == sock->stream.wake_handle);
+                        if (pfd->revents & POLLIN) {
+                            DrainWakeSocket(sock->stream.wake_handle);  // a writer queued output while we slept; we pumped it above, or we'll watch for writability next time.
+                        }
                     }
 
                     pfd++;
@@ -2767,14 +5623,23 @@ int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
 
                 case SOCKETTYPE_DATAGRAM: {
                     bool pump_socket = false;
+                    if (sock->dgram.coalesced_addr && !(edge_triggered && sock->dgram.input_needs_drain)) {
+                        count_it = true;  // still splitting up a merged packet the app hasn't finished receiving.
+                        if (edge_triggered) {
+                            sock->dgram.input_needs_drain = true;
+                        }
+                    }
                     for (int j = 0; j < sock->dgram.num_handles; j++) {
-                        SDL_assert(pfd->fd == sock->dgram.handles[j].handle);
+                        SDL_assert((pfd->fd == sock->dgram.handles[j].handle) || (pfd->fd == INVALID_SOCKET));
                         const bool failed = ((pfd->revents & (POLLERR|POLLHUP|POLLNVAL)) != 0) ? true : false;
                         const bool writable = (pfd->revents & POLLOUT) ? true : false;
                         const bool readable = (pfd->revents & POLLIN) ? true : false;
 
                         if (readable || failed) {
                             count_it = true;
+                            if (edge_triggered) {
+                                sock->dgram.input_needs_drain = true;
+                            }
                         }
 
                         if (writable) {
@@ -2784,18 +5649,25 @@ int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
                     }
 
                     if (pump_socket) {
-                        PumpDatagramSocket(&sock->dgram);
+                        if (!PumpDatagramSocket(&sock->dgram)) {
+                            count_it = true;  // socket failed; return so the app can find out about it.
+                        } else if (sock->dgram.pending_output_len == 0) {
+                            count_it = true;  // finished draining pending output; return so the app can queue more.
+                        }
                     }
                 }
                 break;
 
                 case SOCKETTYPE_SERVER: {
                     for (int j = 0; j < sock->server.num_handles; j++) {
-                        SDL_assert(pfd->fd == sock->server.handles[j]);
+                        SDL_assert((pfd->fd == sock->server.handles[j]) || (pfd->fd == INVALID_SOCKET));
                         const bool failed = ((pfd->revents & (POLLERR|POLLHUP|POLLNVAL)) != 0) ? true : false;
                         const bool readable = (pfd->revents & POLLIN) ? true : false;
                         if (readable || failed) {
                             count_it = true;
+                            if (edge_triggered) {
+                                sock->server.input_needs_drain = true;
+                            }
                         }
                         pfd++;
                     }
@@ -2808,7 +5680,7 @@ int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
             }
         }
 
-        if ((retval > 0) || (endtime == 0)) {
+        if ((retval > 0) || (timeoutms == 0)) {
             break;  // something has input available, or we are doing a no-block poll.
         } else if (timeoutms > 0) {   // We must have woken up for a pending write, etc. Figure out remaining wait time.
             const Uint64 now = SDL_GetTicks();
@@ -2824,3 +5696,13 @@ int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
 
     return retval;
 }
+
+int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, int timeoutms)
+{
+    return WaitUntilInputAvailable(vsockets, numsockets, timeoutms, false);
+}
+
+int NET_WaitUntilNewInputAvailable(void **vsockets, int numsockets, int timeoutms)
+{
+    return WaitUntilInputAvailable(vsockets, numsockets, timeoutms, true);
+}
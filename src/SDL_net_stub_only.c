@@ -40,20 +40,44 @@ NET_StreamSocket * NET_CreateClient(NET_Address *address, Uint16 port, SDL_Prope
 NET_Status NET_WaitUntilConnected(NET_StreamSocket *sock, Sint32 timeout) { SDL_Unsupported(); return NET_FAILURE; }
 NET_Server * NET_CreateServer(NET_Address *addr, Uint16 port, SDL_PropertiesID props) { SDL_Unsupported(); return NULL; }
 bool NET_AcceptClient(NET_Server *server, NET_StreamSocket **client_stream) { SDL_Unsupported(); return false; }
+int NET_AcceptClients(NET_Server *server, NET_StreamSocket **clients, int max) { SDL_Unsupported(); return -1; }
 void NET_DestroyServer(NET_Server *server) {}
 NET_Address * NET_GetStreamSocketAddress(NET_StreamSocket *sock) { SDL_Unsupported(); return NULL; }
 NET_Status NET_GetConnectionStatus(NET_StreamSocket *sock) { SDL_Unsupported(); return NET_FAILURE; }
 bool NET_WriteToStreamSocket(NET_StreamSocket *sock, const void *buf, int buflen) { SDL_Unsupported(); return false; }
+bool NET_WriteToStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt) { SDL_Unsupported(); return false; }
+bool NET_SendFileToStreamSocket(NET_StreamSocket *sock, SDL_IOStream *io, Sint64 offset, Sint64 len, bool closeio) { if (closeio && io) { SDL_CloseIO(io); } SDL_Unsupported(); return false; }
+Sint64 NET_WriteToStreamSocketZeroCopy(NET_StreamSocket *sock, const void *buf, int buflen) { SDL_Unsupported(); return -1; }
+Sint64 NET_GetStreamSocketZeroCopyCompleted(NET_StreamSocket *sock) { SDL_Unsupported(); return -1; }
+bool NET_SetStreamSocketCorked(NET_StreamSocket *sock, bool corked) { SDL_Unsupported(); return false; }
+bool NET_FlushStreamSocket(NET_StreamSocket *sock) { SDL_Unsupported(); return false; }
 int NET_GetStreamSocketPendingWrites(NET_StreamSocket *sock) { SDL_Unsupported(); return -1; }
 int NET_WaitUntilStreamSocketDrained(NET_StreamSocket *sock, Sint32 timeout) { SDL_Unsupported(); return -1; }
+bool NET_SetStreamSocketThreadSafeWrites(NET_StreamSocket *sock, bool enabled) { SDL_Unsupported(); return false; }
 int NET_ReadFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen) { SDL_Unsupported(); return -1; }
+int NET_ReadFromStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt) { SDL_Unsupported(); return -1; }
+int NET_FillFromStreamSocketV(NET_StreamSocket *sock, const NET_IOVec *iov, int iovcnt) { SDL_Unsupported(); return -1; }
+int NET_PeekFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen) { SDL_Unsupported(); return -1; }
+int NET_ReadFromStreamSocketUntil(NET_StreamSocket *sock, const void *delim, int delimlen, void *buf, int buflen) { SDL_Unsupported(); return -1; }
+int NET_ReadExactFromStreamSocket(NET_StreamSocket *sock, void *buf, int buflen) { SDL_Unsupported(); return -1; }
+bool NET_SendMessage(NET_StreamSocket *sock, const void *buf, int buflen) { SDL_Unsupported(); return false; }
+bool NET_ReceiveMessage(NET_StreamSocket *sock, const void **buf, int *buflen) { if (buf) { *buf = NULL; } if (buflen) { *buflen = 0; } SDL_Unsupported(); return false; }
+bool NET_SetStreamSocketMaxMessageSize(NET_StreamSocket *sock, int maxlen) { SDL_Unsupported(); return false; }
 void NET_SimulateStreamPacketLoss(NET_StreamSocket *sock, int percent_loss) {}
 void NET_DestroyStreamSocket(NET_StreamSocket *sock) {}
 NET_DatagramSocket * NET_CreateDatagramSocket(NET_Address *addr, Uint16 port, SDL_PropertiesID props) { SDL_Unsupported(); return NULL; }
+bool NET_ConnectDatagramSocket(NET_DatagramSocket *sock, NET_Address *address, Uint16 port) { SDL_Unsupported(); return false; }
+bool NET_JoinMulticastGroup(NET_DatagramSocket *sock, NET_Address *group, NET_Address *source, NET_Address *iface) { SDL_Unsupported(); return false; }
+bool NET_LeaveMulticastGroup(NET_DatagramSocket *sock, NET_Address *group, NET_Address *source, NET_Address *iface) { SDL_Unsupported(); return false; }
+bool NET_GetDatagramSocketBufferSizes(NET_DatagramSocket *sock, int *send_size, int *receive_size) { SDL_Unsupported(); return false; }
+Sint64 NET_GetDatagramSocketDroppedPackets(NET_DatagramSocket *sock) { SDL_Unsupported(); return -1; }
+bool NET_SetDatagramSocketECN(NET_DatagramSocket *sock, NET_ECN ecn) { SDL_Unsupported(); return false; }
 bool NET_SendDatagram(NET_DatagramSocket *sock, NET_Address *address, Uint16 port, const void *buf, int buflen) { SDL_Unsupported(); return false; }
+bool NET_SendDatagramSegments(NET_DatagramSocket *sock, NET_Address *address, Uint16 port, const void *buf, int buflen, int segment_size) { SDL_Unsupported(); return false; }
 bool NET_ReceiveDatagram(NET_DatagramSocket *sock, NET_Datagram **dgram) { SDL_Unsupported(); return false; }
 void NET_DestroyDatagram(NET_Datagram *dgram) {}
 void NET_SimulateDatagramPacketLoss(NET_DatagramSocket *sock, int percent_loss) {}
 void NET_DestroyDatagramSocket(NET_DatagramSocket *sock) {}
 int NET_WaitUntilInputAvailable(void **vsockets, int numsockets, Sint32 timeout) { SDL_Unsupported(); return -1; }
+int NET_WaitUntilNewInputAvailable(void **vsockets, int numsockets, Sint32 timeout) { SDL_Unsupported(); return -1; }
 